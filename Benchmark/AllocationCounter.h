@@ -0,0 +1,16 @@
+#ifndef ALLOCATIONCOUNTER
+#define ALLOCATIONCOUNTER
+
+#include <cstddef>
+
+// Counts every global operator new of the process. Linking
+// AllocationCounter.cpp replaces the global allocation functions, so this
+// is only meant for the benchmark binary.
+class AllocationCounter {
+ public:
+  static size_t GetCount();
+  // Peak resident set size of the process in bytes, 0 where unknown.
+  static size_t GetPeakResidentBytes();
+};
+
+#endif
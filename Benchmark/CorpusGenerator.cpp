@@ -0,0 +1,317 @@
+#include "CorpusGenerator.h"
+
+#include <iterator>
+
+#include "StaticVocabulary.h"
+
+namespace {
+
+const char* const kEscapes[] = {"\\n", "\\t", "\\\\", "\\\"", "\\'", "\\0"};
+
+const char* const kTypes[] = {"int8",  "int16", "int32", "int64",
+                              "float", "double", "char",  "void"};
+
+// Operators that read naturally between two operands.
+const char* const kBinaryOperators[] = {
+    "+",  "-",  "*",  "/",  "%",  "**", "//", "<",  ">",  "<=",  ">=",
+    "==", "<<", ">>", "&",  "|",  "^",  "&&", "||", "and", "or"};
+
+const char* const kAssignments[] = {"=",  "+=", "-=", "*=", "/=",
+                                    "%=", "&=", "|=", "^=", "<<="};
+
+const char* const kCommentWords[] = {
+    "TODO", "the", "lexer", "skips", "this", "line", "until", "newline",
+    "#",    "\"",  "'",     "==",    "{",    "}",    "0x1F",  "1e-2"};
+
+}  // namespace
+
+CorpusGenerator::CorpusGenerator(uint64_t seed) : state_(seed) {}
+
+const char* CorpusGenerator::GetName(Kind kind) {
+  switch (kind) {
+    case Kind::IDENTIFIERS: return "identifiers";
+    case Kind::NUMBERS: return "numbers";
+    case Kind::LITERALS: return "literals";
+    case Kind::OPERATORS: return "operators";
+    case Kind::COMMENTS: return "comments";
+    case Kind::MIXED: return "mixed";
+  }
+  return "unknown";
+}
+
+std::string CorpusGenerator::Generate(Kind kind, size_t size) {
+  std::string out;
+  out.reserve(size + 256);
+  while (out.size() < size) {
+    switch (kind) {
+      case Kind::IDENTIFIERS:
+        for (size_t i = 0, count = 4 + Below(8); i < count; ++i) {
+          if (i != 0) out += ' ';
+          AppendIdentifier(out);
+        }
+        break;
+      case Kind::NUMBERS:
+        for (size_t i = 0, count = 4 + Below(8); i < count; ++i) {
+          if (i != 0) out += ' ';
+          AppendNumber(out);
+        }
+        break;
+      case Kind::LITERALS:
+        for (size_t i = 0, count = 2 + Below(4); i < count; ++i) {
+          if (i != 0) out += ' ';
+          AppendLiteral(out);
+        }
+        break;
+      case Kind::OPERATORS:
+        for (size_t i = 0, count = 8 + Below(16); i < count; ++i) {
+          if (i != 0) out += ' ';
+          AppendOperator(out);
+        }
+        break;
+      case Kind::COMMENTS:
+        AppendComment(out);
+        if (Below(4) == 0) {
+          out += '\n';
+          AppendIdentifier(out);
+          out += " = ";
+          AppendNumber(out);
+          out += ';';
+        }
+        break;
+      case Kind::MIXED:
+        AppendFunction(out);
+        break;
+    }
+    out += '\n';
+  }
+  return out;
+}
+
+uint64_t CorpusGenerator::Next() {
+  // splitmix64, fully specified unlike the <random> distributions.
+  uint64_t value = (state_ += 0x9E3779B97F4A7C15ull);
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+  return value ^ (value >> 31);
+}
+
+size_t CorpusGenerator::Below(size_t bound) {
+  return static_cast<size_t>(Next() % bound);
+}
+
+const char* CorpusGenerator::Pick(const char* const* words, size_t count) {
+  return words[Below(count)];
+}
+
+void CorpusGenerator::AppendIdentifier(std::string& out) {
+  static const char kFirst[] =
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+  static const char kRest[] =
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+  if (Below(8) == 0) {
+    out += StaticVocabulary::kReserved[Below(
+        std::size(StaticVocabulary::kReserved))];
+    return;
+  }
+  // Like real code, a few names are used over and over and most are rare:
+  // the index is skewed towards the start of the pool.
+  const size_t kNameCount = 4096;
+  if (names_.empty()) {
+    names_.resize(kNameCount);
+    for (std::string& name : names_) {
+      name += kFirst[Below(sizeof(kFirst) - 1)];
+      for (size_t i = 0, length = 1 + Below(14); i < length; ++i) {
+        name += kRest[Below(sizeof(kRest) - 1)];
+      }
+    }
+  }
+  out += names_[Below(Below(kNameCount) + 1)];
+}
+
+void CorpusGenerator::AppendNumber(std::string& out) {
+  static const char kHex[] = "0123456789abcdefABCDEF";
+  auto append_digits = [this, &out](size_t max_length) {
+    out += static_cast<char>('1' + Below(9));
+    for (size_t i = 0, length = Below(max_length); i < length; ++i) {
+      out += static_cast<char>('0' + Below(10));
+    }
+  };
+  switch (Below(5)) {
+    case 0:
+      out += "0x";
+      for (size_t i = 0, length = 1 + Below(8); i < length; ++i) {
+        out += kHex[Below(sizeof(kHex) - 1)];
+      }
+      break;
+    case 1:
+      append_digits(6);
+      out += '.';
+      append_digits(6);
+      break;
+    case 2:
+      append_digits(3);
+      out += Below(2) ? "e" : "E";
+      if (Below(2)) out += Below(2) ? '+' : '-';
+      append_digits(2);
+      break;
+    default:
+      // Well below the 64-bit limit the integers are checked against.
+      append_digits(12);
+      break;
+  }
+}
+
+void CorpusGenerator::AppendLiteral(std::string& out) {
+  if (Below(4) == 0) {
+    out += '\'';
+    if (Below(4) == 0) {
+      out += Pick(kEscapes, std::size(kEscapes));
+    } else {
+      out += static_cast<char>('a' + Below(26));
+    }
+    out += '\'';
+    return;
+  }
+  out += '\"';
+  for (size_t i = 0, length = Below(40); i < length; ++i) {
+    if (Below(16) == 0) {
+      out += Pick(kEscapes, std::size(kEscapes));
+      continue;
+    }
+    // Printable ASCII except the quote and the backslash.
+    char symbol = static_cast<char>(' ' + Below(95));
+    if (symbol == '\"' || symbol == '\\') symbol = '_';
+    out += symbol;
+  }
+  out += '\"';
+}
+
+void CorpusGenerator::AppendOperator(std::string& out) {
+  if (Below(6) == 0) {
+    out += StaticVocabulary::kPunctuation[Below(
+        std::size(StaticVocabulary::kPunctuation))];
+    return;
+  }
+  out += StaticVocabulary::kOperators[Below(
+      std::size(StaticVocabulary::kOperators))];
+}
+
+void CorpusGenerator::AppendComment(std::string& out) {
+  if (Below(3) == 0) {
+    out += Pick(kTypes, std::size(kTypes));
+    out += ' ';
+    AppendIdentifier(out);
+    out += "; ";
+  }
+  out += '#';
+  for (size_t i = 0, count = 3 + Below(12); i < count; ++i) {
+    out += ' ';
+    out += Pick(kCommentWords, std::size(kCommentWords));
+  }
+}
+
+void CorpusGenerator::AppendExpression(std::string& out, int depth) {
+  switch (depth > 0 ? Below(6) : Below(3)) {
+    case 0:
+      AppendIdentifier(out);
+      break;
+    case 1:
+      AppendNumber(out);
+      break;
+    case 2:
+      if (Below(3) == 0) {
+        AppendLiteral(out);
+      } else {
+        AppendIdentifier(out);
+      }
+      break;
+    case 3:
+      out += '(';
+      AppendExpression(out, depth - 1);
+      out += ')';
+      break;
+    case 4:
+      AppendIdentifier(out);
+      out += '(';
+      AppendExpression(out, depth - 1);
+      out += ", ";
+      AppendExpression(out, depth - 1);
+      out += ')';
+      break;
+    default:
+      AppendExpression(out, depth - 1);
+      out += ' ';
+      out += Pick(kBinaryOperators, std::size(kBinaryOperators));
+      out += ' ';
+      AppendExpression(out, depth - 1);
+      break;
+  }
+}
+
+void CorpusGenerator::AppendFunction(std::string& out) {
+  if (Below(3) == 0) {
+    out += "# ";
+    AppendIdentifier(out);
+    out += '\n';
+  }
+  out += "func ";
+  AppendIdentifier(out);
+  out += '(';
+  for (size_t i = 0, count = Below(4); i < count; ++i) {
+    if (i != 0) out += ", ";
+    AppendIdentifier(out);
+  }
+  out += ") : ";
+  out += Pick(kTypes, std::size(kTypes));
+  out += " {\n";
+  for (size_t i = 0, count = 2 + Below(8); i < count; ++i) {
+    out += '\t';
+    switch (Below(5)) {
+      case 0:
+        out += "let ";
+        AppendIdentifier(out);
+        out += " = ";
+        AppendExpression(out, 2);
+        out += ';';
+        break;
+      case 1:
+        out += "if (";
+        AppendExpression(out, 2);
+        out += ") {\n\t\t";
+        AppendIdentifier(out);
+        out += '(';
+        AppendExpression(out, 1);
+        out += ");\n\t}";
+        if (Below(2)) out += " # branch";
+        break;
+      case 2:
+        out += "while (";
+        AppendExpression(out, 2);
+        out += ") ";
+        AppendIdentifier(out);
+        out += ' ';
+        out += Pick(kAssignments, std::size(kAssignments));
+        out += ' ';
+        AppendExpression(out, 1);
+        out += ';';
+        break;
+      case 3:
+        AppendIdentifier(out);
+        out += '[';
+        AppendNumber(out);
+        out += "] ";
+        out += Pick(kAssignments, std::size(kAssignments));
+        out += ' ';
+        AppendExpression(out, 2);
+        out += ';';
+        break;
+      default:
+        out += "return ";
+        AppendExpression(out, 2);
+        out += ';';
+        break;
+    }
+    out += '\n';
+  }
+  out += "}\n";
+}
@@ -0,0 +1,52 @@
+#ifndef CORPUSGENERATOR
+#define CORPUSGENERATOR
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Deterministic synthetic sources for the lexer benchmarks. The same seed,
+// kind and size give the same bytes on every platform and compiler, and
+// every corpus lexes without errors on both engines.
+class CorpusGenerator {
+ public:
+  enum class Kind {
+    IDENTIFIERS,
+    NUMBERS,
+    LITERALS,
+    OPERATORS,
+    COMMENTS,
+    // Functions, declarations and conditions in the style of
+    // lexic_analyzer_tests_/full/*.
+    MIXED
+  };
+  static constexpr Kind kKinds[] = {Kind::IDENTIFIERS, Kind::NUMBERS,
+                                    Kind::LITERALS,    Kind::OPERATORS,
+                                    Kind::COMMENTS,    Kind::MIXED};
+
+  explicit CorpusGenerator(uint64_t seed = 0x5EED);
+
+  static const char* GetName(Kind kind);
+  // Whole lines, at least size bytes.
+  std::string Generate(Kind kind, size_t size);
+
+ private:
+  uint64_t Next();
+  size_t Below(size_t bound);
+  const char* Pick(const char* const* words, size_t count);
+
+  void AppendIdentifier(std::string& out);
+  void AppendNumber(std::string& out);
+  void AppendLiteral(std::string& out);
+  void AppendOperator(std::string& out);
+  void AppendComment(std::string& out);
+  void AppendExpression(std::string& out, int depth);
+  void AppendFunction(std::string& out);
+
+  uint64_t state_;
+  // Names drawn by AppendIdentifier, filled on first use.
+  std::vector<std::string> names_;
+};
+
+#endif
@@ -0,0 +1,188 @@
+// Throughput benchmark for the lexer engines over synthetic corpora.
+//
+//   make && ./lexer_benchmark [--size=MB] [--min-time=SECONDS]
+//                             [--filter=SUBSTRING] [--corpus-dir=DIR]
+//                             [--counters]
+//
+// Every benchmark lexes one corpus kind to completion with one engine,
+// repeating until --min-time has passed, and reports the mean time per
+// pass together with MB/s, tokens/s and global allocations per token.
+// --counters adds the hardware counters of the calling thread per byte and
+// per token, where perf_event_open allows them; parallel_table does most
+// of its work on other threads, which are not counted.
+// --corpus-dir writes the generated corpora out instead, for profiling the
+// command line tool on the same inputs.
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "CorpusGenerator.h"
+#include "HardwareCounters.h"
+#include "LexerVocabulary.h"
+#include "LexicAnalyzer.h"
+#include "ParallelLexer.h"
+#include "SourceBuffer.h"
+
+namespace {
+
+struct Options {
+  size_t corpus_size = 4 << 20;
+  double min_time = 0.5;
+  std::string filter;
+  std::string corpus_dir;
+  bool counters = false;
+};
+
+// Lexes the whole source once and returns the number of tokens.
+using LexFunction = std::function<size_t(const std::string& source)>;
+
+struct Engine {
+  const char* name;
+  LexFunction lex;
+};
+
+struct Measurement {
+  size_t iterations;
+  double seconds_per_iteration;
+  size_t tokens;
+  size_t allocations;
+  HardwareCounters::Sample counters;
+};
+
+// counters may be null.
+Measurement Measure(const LexFunction& lex, const std::string& source,
+                    double min_time, const HardwareCounters* counters) {
+  using Clock = std::chrono::steady_clock;
+  // One untimed pass warms the caches and builds the shared vocabulary.
+  lex(source);
+  Measurement measurement{0, 0.0, 0, 0, {}};
+  size_t allocations_before = AllocationCounter::GetCount();
+  HardwareCounters::Sample counters_before;
+  if (counters != nullptr) counters_before = counters->Read();
+  Clock::time_point start = Clock::now();
+  double elapsed = 0.0;
+  do {
+    measurement.tokens = lex(source);
+    ++measurement.iterations;
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  } while (elapsed < min_time);
+  if (counters != nullptr) {
+    measurement.counters = counters->Read() - counters_before;
+  }
+  measurement.seconds_per_iteration = elapsed / measurement.iterations;
+  measurement.allocations =
+      (AllocationCounter::GetCount() - allocations_before) /
+      measurement.iterations;
+  return measurement;
+}
+
+bool ParseOptions(int argc, const char* argv[], Options& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (argument.rfind("--size=", 0) == 0) {
+      options.corpus_size =
+          static_cast<size_t>(std::stod(argument.substr(7)) * (1 << 20));
+    } else if (argument.rfind("--min-time=", 0) == 0) {
+      options.min_time = std::stod(argument.substr(11));
+    } else if (argument.rfind("--filter=", 0) == 0) {
+      options.filter = argument.substr(9);
+    } else if (argument.rfind("--corpus-dir=", 0) == 0) {
+      options.corpus_dir = argument.substr(13);
+    } else if (argument == "--counters") {
+      options.counters = true;
+    } else {
+      std::printf("unknown argument %s\n", argv[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) return 1;
+
+  std::shared_ptr<const LexerVocabulary> vocabulary =
+      LexerVocabulary::Default();
+  auto analyze = [vocabulary](LexicAnalyzer::Engine engine) {
+    return [vocabulary, engine](const std::string& source) {
+      LexicAnalyzer analyzer(SourceBuffer::View(source.data(), source.size()),
+                             vocabulary, engine);
+      return analyzer.GetTokens().Size();
+    };
+  };
+  auto parallel_lexer = std::make_shared<ParallelLexer>(
+      vocabulary, LexicAnalyzer::Engine::TABLE);
+  const Engine engines[] = {
+      {"states", analyze(LexicAnalyzer::Engine::STATE_MACHINE)},
+      {"table", analyze(LexicAnalyzer::Engine::TABLE)},
+      {"parallel_table", [parallel_lexer](const std::string& source) {
+         parallel_lexer->Lex(SourceBuffer::View(source.data(), source.size()));
+         return parallel_lexer->GetTokens().size();
+       }}};
+
+  std::unique_ptr<HardwareCounters> counters;
+  if (options.counters) {
+    counters = std::make_unique<HardwareCounters>();
+    if (!counters->GetError().empty()) {
+      std::printf("hardware counters: %s\n", counters->GetError().c_str());
+    }
+    if (!counters->IsAvailable()) counters.reset();
+  }
+
+  std::printf("%-40s %12s %10s %10s %12s %13s\n", "Benchmark", "Time",
+              "Iterations", "MB/s", "Mtokens/s", "allocs/token");
+  for (CorpusGenerator::Kind kind : CorpusGenerator::kKinds) {
+    CorpusGenerator generator;
+    std::string source = generator.Generate(kind, options.corpus_size);
+    std::string kind_name = CorpusGenerator::GetName(kind);
+
+    if (!options.corpus_dir.empty()) {
+      std::string file_name = options.corpus_dir + "/" + kind_name + ".txt";
+      std::ofstream corpus(file_name, std::ios::binary);
+      corpus.write(source.data(), source.size());
+      std::printf("wrote %s (%zu bytes)\n", file_name.c_str(), source.size());
+      continue;
+    }
+
+    for (const Engine& engine : engines) {
+      std::string name = "BM_GetTokens/" + kind_name + "/" + engine.name;
+      if (name.find(options.filter) == std::string::npos) continue;
+      Measurement measurement =
+          Measure(engine.lex, source, options.min_time, counters.get());
+      double seconds = measurement.seconds_per_iteration;
+      std::printf("%-40s %9.3f ms %10zu %10.1f %12.2f %13.3f\n",
+                  name.c_str(), seconds * 1e3, measurement.iterations,
+                  source.size() / seconds / (1 << 20),
+                  measurement.tokens / seconds / 1e6,
+                  static_cast<double>(measurement.allocations) /
+                      measurement.tokens);
+      if (!counters) continue;
+      const std::pair<const char*, double> units[] = {
+          {"per byte", static_cast<double>(source.size())},
+          {"per token", static_cast<double>(measurement.tokens)}};
+      for (const auto& [unit, count] : units) {
+        double per = count * measurement.iterations;
+        std::printf("  %-9s", unit);
+        for (size_t i = 0; i < HardwareCounters::kCounterCount; ++i) {
+          auto counter = static_cast<HardwareCounters::Counter>(i);
+          if (!counters->IsAvailable(counter)) continue;
+          std::printf(" %s %.3f", HardwareCounters::GetName(counter),
+                      measurement.counters[counter] / per);
+        }
+        std::printf("\n");
+      }
+    }
+  }
+  std::printf("peak RSS: %.1f MB\n",
+              AllocationCounter::GetPeakResidentBytes() / double(1 << 20));
+  return 0;
+}
@@ -0,0 +1,195 @@
+#include "BatchLexer.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "SourceBuffer.h"
+#include "Token.h"
+#include "TokenStreamWriter.h"
+
+BatchLexer::BatchLexer(std::shared_ptr<const LexerVocabulary> vocabulary,
+                       LexicAnalyzer::Engine engine, size_t thread_count,
+                       std::shared_ptr<StringInterner> interner) :
+      vocabulary_(std::move(vocabulary)),
+      interner_(interner ? std::move(interner)
+                         : std::make_shared<StringInterner>()),
+      engine_(engine),
+      max_errors_(0),
+      format_(OutputFormat::TEXT),
+      pool_(thread_count) {}
+
+std::vector<BatchLexer::Result> BatchLexer::Run(
+    const std::vector<std::string>& input_files) {
+  std::vector<Result> results(input_files.size());
+  std::unordered_map<std::string, size_t> first_index;
+  for (size_t i = 0; i < input_files.size(); ++i) {
+    if (!first_index.emplace(input_files[i], i).second) continue;
+    // Each task writes only its own slot, results is never resized.
+    pool_.Submit([this, &input_files, &results, i] {
+      results[i] = LexFile(input_files[i],
+                           input_files[i] + (format_ == OutputFormat::TEXT
+                                                 ? ".tokens.txt"
+                                                 : ".tokens.bin"));
+    });
+  }
+  pool_.Wait();
+  for (size_t i = 0; i < input_files.size(); ++i) {
+    size_t first = first_index[input_files[i]];
+    if (first != i) results[i] = results[first];
+  }
+  return results;
+}
+
+void BatchLexer::SetMaxErrors(size_t max_errors) {
+  max_errors_ = max_errors;
+}
+
+void BatchLexer::SetOutputFormat(OutputFormat format) { format_ = format; }
+
+void BatchLexer::SetCache(std::shared_ptr<TokenCache> cache) {
+  cache_ = std::move(cache);
+}
+
+size_t BatchLexer::GetThreadCount() const { return pool_.GetThreadCount(); }
+
+StringInterner& BatchLexer::GetInterner() { return *interner_; }
+
+std::vector<std::string> BatchLexer::ReadResponseFile(
+    const std::string& file_name) {
+  std::ifstream response(file_name);
+  if (!response.is_open()) {
+    throw std::runtime_error(
+        "exception thrown: unable to open response file " + file_name);
+  }
+  std::vector<std::string> input_files;
+  std::string line;
+  while (std::getline(response, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (!line.empty()) input_files.push_back(line);
+  }
+  return input_files;
+}
+
+namespace {
+
+void WriteToken(const Token& token, std::ostream& output) {
+  static const char* const token_type[] = {
+        "RESERVED", 
+        "IDENTIFIER", 
+        "NUMERIC_CONSTANT", 
+        "LITERAL_CONSTANT", 
+        "OPERATOR", 
+        "PUNCTUATION",
+        "ERROR"
+  };
+  output << token_type[static_cast<int>(token.type)] << ' ' << token.symbol
+         << '\n';
+}
+
+// Writes the tokens and adds them to writer as well. Text is written as it
+// is lexed, a token file once all tokens are known; either way the tokens
+// before an error are kept.
+void CollectTokens(LexicAnalyzer& analyzer, std::ostream& output,
+                   BatchLexer::OutputFormat format,
+                   TokenStreamWriter& writer) {
+  bool is_text = format == BatchLexer::OutputFormat::TEXT;
+  try {
+    for (const Token& cur_token : analyzer.Tokens()) {
+      if (is_text) WriteToken(cur_token, output);
+      writer.Add(cur_token);
+    }
+  } catch (...) {
+    if (!is_text) writer.Write(output);
+    throw;
+  }
+  if (!is_text) writer.Write(output);
+}
+
+}  // namespace
+
+void BatchLexer::WriteTokens(LexicAnalyzer& analyzer, std::ostream& output,
+                             OutputFormat format) {
+  if (format == OutputFormat::TEXT) {
+    for (const Token& cur_token : analyzer.Tokens()) {
+      WriteToken(cur_token, output);
+    }
+    return;
+  }
+  TokenStreamWriter writer;
+  CollectTokens(analyzer, output, format, writer);
+}
+
+void BatchLexer::WriteTokens(const std::vector<Token>& tokens,
+                             std::ostream& output, OutputFormat format) {
+  if (format == OutputFormat::TEXT) {
+    for (const Token& cur_token : tokens) WriteToken(cur_token, output);
+    return;
+  }
+  TokenStreamWriter writer;
+  for (const Token& cur_token : tokens) writer.Add(cur_token);
+  writer.Write(output);
+}
+
+BatchLexer::Result BatchLexer::LexFile(const std::string& input_file,
+                                       const std::string& output_file) const {
+  Result result;
+  result.input_file = input_file;
+  result.output_file = output_file;
+  std::ios::openmode output_mode = format_ == OutputFormat::TEXT
+                                       ? std::ios::out
+                                       : std::ios::out | std::ios::binary;
+  // Tasks must not throw, every failure ends up in result.error.
+  try {
+    SourceBuffer source(input_file);
+    if (!source.IsOpen()) {
+      result.error = "Unable to open analyzed file";
+      result.error_count = 1;
+      return result;
+    }
+    uint64_t key = 0;
+    if (cache_) {
+      key = cache_->GetKey(source, engine_);
+      if (std::unique_ptr<TokenStreamReader> cached = cache_->Find(key)) {
+        std::vector<Token> tokens(cached->Size());
+        for (size_t i = 0; i < tokens.size(); ++i) {
+          tokens[i] = cached->GetToken(i);
+        }
+        std::ofstream file_output(result.output_file, output_mode);
+        if (!file_output.is_open()) {
+          result.error = "Unable to open output stream";
+          result.error_count = 1;
+          return result;
+        }
+        WriteTokens(tokens, file_output, format_);
+        return result;
+      }
+    }
+    LexicAnalyzer analyzer(std::move(source), vocabulary_, engine_, 1,
+                           interner_);
+    analyzer.SetMaxErrors(max_errors_);
+    std::ofstream file_output(result.output_file, output_mode);
+    if (!file_output.is_open()) {
+      result.error = "Unable to open output stream";
+      result.error_count = 1;
+      return result;
+    }
+    if (cache_) {
+      TokenStreamWriter writer;
+      CollectTokens(analyzer, file_output, format_, writer);
+      // Diagnostics are not cached, so neither are files that have any.
+      if (analyzer.GetDiagnostics().empty()) cache_->Store(key, writer);
+    } else {
+      WriteTokens(analyzer, file_output, format_);
+    }
+    for (const Diagnostic& diagnostic : analyzer.GetDiagnostics()) {
+      if (!result.error.empty()) result.error += '\n';
+      result.error += analyzer.FormatDiagnostic(diagnostic);
+      ++result.error_count;
+    }
+  } catch (const std::exception& e) {
+    result.error = e.what();
+    result.error_count = 1;
+  }
+  return result;
+}
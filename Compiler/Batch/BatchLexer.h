@@ -0,0 +1,80 @@
+#ifndef BATCHLEXER
+#define BATCHLEXER
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "LexicAnalyzer.h"
+#include "LexerVocabulary.h"
+#include "StringInterner.h"
+#include "ThreadPool.h"
+#include "Token.h"
+#include "TokenCache.h"
+
+// Lexes many files concurrently. All analyzers share one vocabulary and
+// every file is written to its own <input>.tokens.txt (.tokens.bin for
+// BINARY output), so the outputs do not depend on which worker lexed which
+// file or in what order. They also share one StringInterner, so an
+// identifier has the same symbol_id in every file.
+class BatchLexer {
+ public:
+  // TEXT writes one "TYPE symbol" line per token, BINARY a token file
+  // TokenStreamReader can map (see TokenStreamFormat.h).
+  enum class OutputFormat {
+    TEXT,
+    BINARY
+  };
+
+  struct Result {
+    std::string input_file;
+    std::string output_file;
+    // Empty when the file was lexed completely. Every recorded diagnostic,
+    // one after another, when recovering from errors.
+    std::string error;
+    size_t error_count = 0;
+  };
+
+  // Creates its own interner when none is given.
+  BatchLexer(std::shared_ptr<const LexerVocabulary> vocabulary,
+             LexicAnalyzer::Engine engine, size_t thread_count = 0,
+             std::shared_ptr<StringInterner> interner = nullptr);
+
+  // Results are in the order of input_files. A path listed more than once
+  // is lexed once.
+  std::vector<Result> Run(const std::vector<std::string>& input_files);
+  // Lexes one file on the calling thread.
+  Result LexFile(const std::string& input_file,
+                 const std::string& output_file) const;
+  // See LexicAnalyzer::SetMaxErrors(); applies to every file.
+  void SetMaxErrors(size_t max_errors);
+  void SetOutputFormat(OutputFormat format);
+  // Files found in the cache are not lexed at all, files lexed without
+  // errors are added to it. Null turns caching off.
+  void SetCache(std::shared_ptr<TokenCache> cache);
+  size_t GetThreadCount() const;
+  StringInterner& GetInterner();
+
+  // One path per line, blank lines are skipped.
+  static std::vector<std::string> ReadResponseFile(
+      const std::string& file_name);
+  // BINARY output has to be opened in binary mode.
+  static void WriteTokens(LexicAnalyzer& analyzer, std::ostream& output,
+                          OutputFormat format = OutputFormat::TEXT);
+  static void WriteTokens(const std::vector<Token>& tokens,
+                          std::ostream& output,
+                          OutputFormat format = OutputFormat::TEXT);
+
+ private:
+  std::shared_ptr<const LexerVocabulary> vocabulary_;
+  std::shared_ptr<StringInterner> interner_;
+  LexicAnalyzer::Engine engine_;
+  size_t max_errors_;
+  OutputFormat format_;
+  std::shared_ptr<TokenCache> cache_;
+  ThreadPool pool_;
+};
+
+#endif
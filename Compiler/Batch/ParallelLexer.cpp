@@ -0,0 +1,98 @@
+#include "ParallelLexer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#include "Scanner.h"
+
+ParallelLexer::ParallelLexer(
+    std::shared_ptr<const LexerVocabulary> vocabulary,
+    LexicAnalyzer::Engine engine, size_t thread_count,
+    size_t min_chunk_size, std::shared_ptr<StringInterner> interner) :
+      vocabulary_(std::move(vocabulary)),
+      interner_(interner ? std::move(interner)
+                         : std::make_shared<StringInterner>()),
+      engine_(engine),
+      min_chunk_size_(std::max<size_t>(min_chunk_size, 1)),
+      pool_(thread_count) {}
+
+void ParallelLexer::Lex(const SourceBuffer& source) {
+  tokens_.clear();
+  if (source.Size() > UINT32_MAX) {
+    throw std::runtime_error(
+        "exception thrown: source files must be smaller than 4 GiB");
+  }
+  chunks_ = Split(source);
+
+  for (Chunk& chunk : chunks_) {
+    pool_.Submit([this, &chunk] { LexChunk(chunk); });
+  }
+  pool_.Wait();
+
+  #pragma region SEAMS
+  for (size_t i = 0; i < chunks_.size(); ++i) {
+    if (chunks_[i].error) {
+      // Chunks are lexed as if they started on line 1; only the chunk
+      // that reports the error needs its real first line.
+      chunks_[i].first_line = 1;
+      for (const char* cursor = source.Begin(); cursor != chunks_[i].begin;
+           ++cursor) {
+        cursor = Scanner::FindNewline(cursor, chunks_[i].begin);
+        if (cursor == chunks_[i].begin) break;
+        ++chunks_[i].first_line;
+      }
+      LexChunk(chunks_[i]);
+    }
+    uint32_t chunk_offset =
+        static_cast<uint32_t>(chunks_[i].begin - source.Begin());
+    for (Token& token : chunks_[i].tokens) {
+      token.offset += chunk_offset;
+      tokens_.push_back(token);
+    }
+    if (chunks_[i].error) std::rethrow_exception(chunks_[i].error);
+  }
+  #pragma endregion SEAMS
+}
+
+const std::vector<Token>& ParallelLexer::GetTokens() const { return tokens_; }
+
+StringInterner& ParallelLexer::GetInterner() { return *interner_; }
+
+std::vector<ParallelLexer::Chunk> ParallelLexer::Split(
+    const SourceBuffer& source) const {
+  const char* cursor = source.Begin();
+  const char* end = source.End();
+  // A few chunks per thread even out lines of very different density.
+  size_t chunk_size =
+      std::max(min_chunk_size_, source.Size() / (pool_.GetThreadCount() * 4));
+  std::vector<Chunk> chunks;
+  do {
+    const char* chunk_end = end;
+    if (static_cast<size_t>(end - cursor) > chunk_size) {
+      const char* newline = Scanner::FindNewline(cursor + chunk_size, end);
+      if (newline != end) chunk_end = newline + 1;
+    }
+    Chunk chunk;
+    chunk.begin = cursor;
+    chunk.end = chunk_end;
+    chunk.first_line = 1;
+    chunks.push_back(std::move(chunk));
+    cursor = chunk_end;
+  } while (cursor != end);
+  return chunks;
+}
+
+void ParallelLexer::LexChunk(Chunk& chunk) const {
+  chunk.tokens.clear();
+  chunk.error = nullptr;
+  chunk.analyzer = std::make_unique<LexicAnalyzer>(
+      SourceBuffer::View(chunk.begin, chunk.end - chunk.begin), vocabulary_,
+      engine_, chunk.first_line, interner_);
+  Token token;
+  try {
+    while (chunk.analyzer->NextToken(token)) chunk.tokens.push_back(token);
+  } catch (...) {
+    chunk.error = std::current_exception();
+  }
+}
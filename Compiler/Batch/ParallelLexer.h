@@ -0,0 +1,63 @@
+#ifndef PARALLELLEXER
+#define PARALLELLEXER
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include "LexicAnalyzer.h"
+#include "LexerVocabulary.h"
+#include "StringInterner.h"
+#include "SourceBuffer.h"
+#include "ThreadPool.h"
+#include "Token.h"
+
+// Lexes one large source on several cores. The source is cut into chunks
+// right after a '\n' and every chunk is lexed from the begin state at the
+// same time. No token runs across a line break, not even a literal, which
+// is unterminated at the end of its line, so every cut falls between two
+// tokens. The tokens and the first error are exactly those of a sequential
+// LexicAnalyzer, up to which symbol_id each identifier gets.
+class ParallelLexer {
+ public:
+  static constexpr size_t kDefaultChunkSize = 1 << 20;
+
+  ParallelLexer(std::shared_ptr<const LexerVocabulary> vocabulary,
+                LexicAnalyzer::Engine engine, size_t thread_count = 0,
+                size_t min_chunk_size = kDefaultChunkSize,
+                std::shared_ptr<StringInterner> interner = nullptr);
+
+  // source must outlive the tokens. On an error GetTokens() holds every
+  // token before it and the error is rethrown as the sequential analyzer
+  // would have thrown it.
+  void Lex(const SourceBuffer& source);
+  // Valid until the next Lex().
+  const std::vector<Token>& GetTokens() const;
+  // Shared by all chunks, and by all sources lexed with this instance.
+  StringInterner& GetInterner();
+
+ private:
+  struct Chunk {
+    const char* begin;
+    const char* end;
+    size_t first_line;
+    // Owns the text of the tokens it produced that are not in the source.
+    std::unique_ptr<LexicAnalyzer> analyzer;
+    std::vector<Token> tokens;
+    std::exception_ptr error;
+  };
+
+  std::vector<Chunk> Split(const SourceBuffer& source) const;
+  void LexChunk(Chunk& chunk) const;
+
+  std::shared_ptr<const LexerVocabulary> vocabulary_;
+  std::shared_ptr<StringInterner> interner_;
+  LexicAnalyzer::Engine engine_;
+  size_t min_chunk_size_;
+  ThreadPool pool_;
+  std::vector<Chunk> chunks_;
+  std::vector<Token> tokens_;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(size_t thread_count) :
+      unfinished_(0),
+      queued_(0),
+      next_queue_(0),
+      is_stopping_(false) {
+  if (thread_count == 0) thread_count = std::thread::hardware_concurrency();
+  if (thread_count == 0) thread_count = 1;
+  for (size_t i = 0; i < thread_count; ++i) {
+    queues_.push_back(std::make_unique<TaskQueue>());
+  }
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads_.emplace_back(&ThreadPool::Work, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = true;
+  }
+  task_available_.notify_all();
+  for (std::thread& thread : threads_) thread.join();
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TaskQueue& queue = *queues_[next_queue_];
+    next_queue_ = (next_queue_ + 1) % queues_.size();
+    {
+      std::lock_guard<std::mutex> queue_lock(queue.mutex);
+      queue.tasks.push_back(std::move(task));
+    }
+    ++unfinished_;
+    ++queued_;
+  }
+  task_available_.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  all_done_.wait(lock, [this] { return unfinished_ == 0; });
+}
+
+size_t ThreadPool::GetThreadCount() const { return threads_.size(); }
+
+void ThreadPool::Work(size_t index) {
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_available_.wait(lock,
+                           [this] { return queued_ > 0 || is_stopping_; });
+      if (queued_ == 0) return;
+    }
+    std::function<void()> task;
+    if (!TryPop(index, task) && !TrySteal(index, task)) continue;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --queued_;
+    }
+    task();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--unfinished_ == 0) all_done_.notify_all();
+  }
+}
+
+bool ThreadPool::TryPop(size_t index, std::function<void()>& task) {
+  TaskQueue& queue = *queues_[index];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty()) return false;
+  task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  return true;
+}
+
+bool ThreadPool::TrySteal(size_t index, std::function<void()>& task) {
+  for (size_t offset = 1; offset < queues_.size(); ++offset) {
+    TaskQueue& queue = *queues_[(index + offset) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) continue;
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+  }
+  return false;
+}
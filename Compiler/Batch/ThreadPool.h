@@ -0,0 +1,54 @@
+#ifndef THREADPOOL
+#define THREADPOOL
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool where every worker owns a task deque. Submit() deals
+// tasks round-robin, a worker pops its own newest task first and, once its
+// deque is empty, steals the oldest task of another worker, so a few large
+// files do not leave the other cores idle. Tasks must not throw.
+class ThreadPool {
+ public:
+  // Zero means one thread per hardware core.
+  explicit ThreadPool(size_t thread_count = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  void Submit(std::function<void()> task);
+  // Blocks until every submitted task has finished.
+  void Wait();
+  size_t GetThreadCount() const;
+
+ private:
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  void Work(size_t index);
+  bool TryPop(size_t index, std::function<void()>& task);
+  bool TrySteal(size_t index, std::function<void()>& task);
+
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable task_available_;
+  std::condition_variable all_done_;
+  // Guarded by mutex_, which Submit() holds while pushing so that a worker
+  // never takes a task before it is counted.
+  size_t unfinished_;
+  size_t queued_;
+  size_t next_queue_;
+  bool is_stopping_;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef DIAGNOSTIC
+#define DIAGNOSTIC
+
+#include <cstdint>
+
+// An error recorded instead of thrown by a LexicAnalyzer with a non-zero
+// error limit. message is a string literal, so recording one allocates
+// nothing; LexicAnalyzer::FormatDiagnostic() gives the full text.
+struct Diagnostic {
+  enum class Code : uint8_t {
+    UNEXPECTED_SYMBOL,
+    UNTERMINATED_LITERAL,
+    INVALID_CHAR_LITERAL,
+    MALFORMED_NUMBER,
+    NUMBER_OUT_OF_RANGE,
+    // A backslash followed by a character backslashes.txt does not list.
+    INVALID_ESCAPE,
+    // The error limit was reached and the rest of the source was skipped.
+    TOO_MANY_ERRORS
+  };
+  // Messages that both lexer engines report, so that they agree on the
+  // text as well.
+  static constexpr const char* kUnterminatedLiteral =
+      "error: unexpected end of literal constant";
+  static constexpr const char* kCharLiteralError =
+      "exception thrown: data-type char can only contain single character";
+  static constexpr const char* kUnknownEscape =
+      "error: unknown escape sequence";
+
+  Code code;
+  // Byte offset into the analyzed source where the error was detected.
+  uint32_t offset;
+  const char* message;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "Arena.h"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+Arena::Arena(size_t block_size) :
+      block_size_(block_size),
+      cursor_(nullptr),
+      left_(0),
+      used_(0) {}
+
+Arena::Arena(Arena&& other) noexcept :
+      block_size_(other.block_size_),
+      blocks_(std::move(other.blocks_)),
+      cursor_(std::exchange(other.cursor_, nullptr)),
+      left_(std::exchange(other.left_, 0)),
+      used_(std::exchange(other.used_, 0)) {
+  other.blocks_.clear();
+}
+
+Arena& Arena::operator=(Arena&& other) noexcept {
+  if (this == &other) return *this;
+  block_size_ = other.block_size_;
+  blocks_ = std::move(other.blocks_);
+  other.blocks_.clear();
+  cursor_ = std::exchange(other.cursor_, nullptr);
+  left_ = std::exchange(other.left_, 0);
+  used_ = std::exchange(other.used_, 0);
+  return *this;
+}
+
+char* Arena::Allocate(size_t size, size_t alignment) {
+  size_t padding =
+      (alignment - reinterpret_cast<uintptr_t>(cursor_) % alignment) %
+      alignment;
+  if (cursor_ == nullptr || size + padding > left_) {
+    // new[] memory is aligned for any fundamental type.
+    if (size > block_size_ / 4) {
+      blocks_.emplace_back(new char[size]);
+      used_ += size;
+      return blocks_.back().get();
+    }
+    blocks_.emplace_back(new char[block_size_]);
+    cursor_ = blocks_.back().get();
+    left_ = block_size_;
+    padding = 0;
+  }
+  char* allocated = cursor_ + padding;
+  cursor_ += size + padding;
+  left_ -= size + padding;
+  used_ += size;
+  return allocated;
+}
+
+std::string_view Arena::Copy(std::string_view text) {
+  char* copy = Allocate(text.size());
+  if (!text.empty()) std::memcpy(copy, text.data(), text.size());
+  return std::string_view(copy, text.size());
+}
+
+size_t Arena::GetUsedBytes() const { return used_; }
@@ -0,0 +1,39 @@
+#ifndef ARENA
+#define ARENA
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Bump allocator for text that lives exactly as long as its owner, such as
+// the symbols of an analyzer's tokens. Memory comes from blocks that never
+// move and is only given back all at once, when the arena is destroyed, so
+// an allocation is a pointer increment almost every time.
+class Arena {
+ public:
+  static constexpr size_t kDefaultBlockSize = 1 << 16;
+
+  explicit Arena(size_t block_size = kDefaultBlockSize);
+  Arena(Arena&& other) noexcept;
+  Arena& operator=(Arena&& other) noexcept;
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Never returns nullptr, not even for size 0.
+  char* Allocate(size_t size, size_t alignment = 1);
+  std::string_view Copy(std::string_view text);
+  // Bytes handed out so far, padding not included.
+  size_t GetUsedBytes() const;
+
+ private:
+  size_t block_size_;
+  // Requests larger than a quarter of a block get a block of their own and
+  // leave the current one open.
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* cursor_;
+  size_t left_;
+  size_t used_;
+};
+
+#endif
@@ -1,36 +1,38 @@
 #include "BeginState.h"
 #include "LexicAnalyzer.h"
+#include "UnicodeClasses.h"
+#include "Utf8.h"
 
 BeginState::BeginState(LexicAnalyzer* fsm) : state_machine_(fsm) {}
 
 void BeginState::Execute() {
-  wchar_t peek = state_machine_->Peek();
-  if (peek == L'\"') {
+  char32_t peek = state_machine_->Peek();
+  if (peek == '\"') {
     state_machine_->SkipChar();
     state_machine_->GetLitConstState()->SetState(0);
     state_machine_->ChangeState(state_machine_->GetLitConstState());
     return;
   }
-  if (peek == L'\'') {
+  if (peek == '\'') {
     state_machine_->SkipChar();
     state_machine_->GetLitConstState()->SetState(1);
     state_machine_->ChangeState(state_machine_->GetLitConstState());
     return;
   }
-  if (peek == L'\n' || peek == L' ' || peek == L'\t') {
-    state_machine_->SkipChar();
+  if (peek == '\n' || peek == ' ' || peek == '\t' || peek == '\r') {
+    state_machine_->SkipBlanks();
     return;
   }
-  if (peek == L'#') {
+  if (peek == '#') {
     state_machine_->SkipLine();
     return;
   }
-  if (iswdigit(peek)) {
+  if (UnicodeClasses::IsDigit(peek)) {
     //state_machine_->AddNextCharToBuffer();
     state_machine_->ChangeState(state_machine_->GetNumberState());
     return;
   }
-  if (iswalpha(peek) || peek == L'_') {
+  if (UnicodeClasses::IsIdentifierStart(peek)) {
     state_machine_->AddNextCharToBuffer();
     state_machine_->ChangeState(state_machine_->GetIDState());
     return;
@@ -40,10 +42,13 @@ void BeginState::Execute() {
     state_machine_->AddBufferToQueue(Token::Type::PUNCTUATION);
     return;
   }
-  if (state_machine_->IsOperator(std::wstring(1, peek))) {
+  std::string symbol;
+  AppendUtf8(symbol, peek);
+  if (state_machine_->IsOperator(symbol)) {
     state_machine_->AddNextCharToBuffer();
     state_machine_->ChangeState(state_machine_->GetOperatorState());
     return;
   }
-  state_machine_->ThrowException("exception thrown: unexpected symbol ");
+  state_machine_->ReportError(Diagnostic::Code::UNEXPECTED_SYMBOL,
+                              "exception thrown: unexpected symbol ");
 }
\ No newline at end of file
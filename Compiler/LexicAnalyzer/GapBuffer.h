@@ -0,0 +1,85 @@
+#ifndef GAPBUFFER
+#define GAPBUFFER
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+// A sequence kept the way editors keep their text: with a gap at a movable
+// index. Inserting and erasing at the gap costs as much as the change and
+// moving the gap as much as the elements it passes, so a run of changes
+// close to each other never touches the rest of the sequence. The elements
+// in front of the gap and those behind it are each contiguous.
+template <typename T>
+class GapBuffer {
+ public:
+  size_t GetSize() const { return items_.size() - (gap_end_ - gap_begin_); }
+  // Index of the first element behind the gap.
+  size_t GetGap() const { return gap_begin_; }
+
+  T& operator[](size_t index) { return items_[Locate(index)]; }
+  const T& operator[](size_t index) const { return items_[Locate(index)]; }
+
+  // The elements from GetGap() on.
+  const T* GetTail() const { return items_.data() + gap_end_; }
+
+  // Moves the gap in front of index. cross(element, behind) is called for
+  // every element that passes it, with whether it is now behind the gap.
+  template <typename Cross>
+  void MoveGap(size_t index, Cross cross) {
+    if (index < gap_begin_) {
+      size_t count = gap_begin_ - index;
+      std::move_backward(items_.begin() + index, items_.begin() + gap_begin_,
+                         items_.begin() + gap_end_);
+      gap_begin_ -= count;
+      gap_end_ -= count;
+      for (size_t i = gap_end_; i < gap_end_ + count; ++i) {
+        cross(items_[i], true);
+      }
+    } else if (index > gap_begin_) {
+      size_t count = index - gap_begin_;
+      std::move(items_.begin() + gap_end_, items_.begin() + gap_end_ + count,
+                items_.begin() + gap_begin_);
+      for (size_t i = gap_begin_; i < gap_begin_ + count; ++i) {
+        cross(items_[i], false);
+      }
+      gap_begin_ += count;
+      gap_end_ += count;
+    }
+  }
+
+  void MoveGap(size_t index) {
+    MoveGap(index, [](T&, bool) {});
+  }
+
+  // Removes count elements behind the gap.
+  void Erase(size_t count) { gap_end_ += count; }
+
+  // Inserts in front of the gap.
+  template <typename Iterator>
+  void Insert(Iterator begin, Iterator end) {
+    size_t count = static_cast<size_t>(std::distance(begin, end));
+    if (gap_end_ - gap_begin_ < count) {
+      // Growing by half of the size keeps appending amortized constant.
+      size_t tail = items_.size() - gap_end_;
+      items_.resize(gap_begin_ + count + GetSize() / 2 + tail);
+      std::move_backward(items_.begin() + gap_end_,
+                         items_.begin() + gap_end_ + tail, items_.end());
+      gap_end_ = items_.size() - tail;
+    }
+    std::copy(begin, end, items_.begin() + gap_begin_);
+    gap_begin_ += count;
+  }
+
+ private:
+  size_t Locate(size_t index) const {
+    return index < gap_begin_ ? index : index + (gap_end_ - gap_begin_);
+  }
+
+  std::vector<T> items_;
+  size_t gap_begin_ = 0;
+  size_t gap_end_ = 0;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "HardwareCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+HardwareCounters::HardwareCounters() : group_(-1), opened_(0) {
+  files_.fill(-1);
+#ifdef __linux__
+  static const uint64_t kConfigs[kCounterCount] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+  for (size_t counter = 0; counter < kCounterCount; ++counter) {
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.config = kConfigs[counter];
+    // User space only, which a perf_event_paranoid of 2 still allows.
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_GROUP |
+                             PERF_FORMAT_TOTAL_TIME_ENABLED |
+                             PERF_FORMAT_TOTAL_TIME_RUNNING;
+    int file = static_cast<int>(
+        syscall(SYS_perf_event_open, &attributes, 0, -1, group_, 0));
+    if (file == -1) {
+      if (error_.empty()) {
+        error_ = std::string("perf_event_open of ") +
+                 GetName(static_cast<Counter>(counter)) + " failed: " +
+                 std::strerror(errno);
+      }
+      continue;
+    }
+    if (group_ == -1) group_ = file;
+    files_[counter] = file;
+    order_[opened_++] = static_cast<Counter>(counter);
+  }
+#else
+  error_ = "hardware counters need Linux perf_event_open";
+#endif
+}
+
+HardwareCounters::~HardwareCounters() {
+#ifdef __linux__
+  for (int file : files_) {
+    if (file != -1) close(file);
+  }
+#endif
+}
+
+bool HardwareCounters::IsAvailable() const { return group_ != -1; }
+
+bool HardwareCounters::IsAvailable(Counter counter) const {
+  return files_[counter] != -1;
+}
+
+const std::string& HardwareCounters::GetError() const { return error_; }
+
+HardwareCounters::Sample HardwareCounters::Read() const {
+  Sample sample;
+#ifdef __linux__
+  if (group_ == -1) return sample;
+  // The number of counters, the times enabled and running, the values.
+  uint64_t group[3 + kCounterCount];
+  ssize_t size = read(group_, group, sizeof(group));
+  if (size < static_cast<ssize_t>((3 + opened_) * sizeof(uint64_t)) ||
+      group[2] == 0) {
+    return sample;
+  }
+  double scale = static_cast<double>(group[1]) / group[2];
+  for (size_t i = 0; i < group[0] && i < opened_; ++i) {
+    sample.values[order_[i]] =
+        group[1] == group[2] ? group[3 + i]
+                             : static_cast<uint64_t>(group[3 + i] * scale);
+  }
+#endif
+  return sample;
+}
+
+const char* HardwareCounters::GetName(Counter counter) {
+  switch (counter) {
+    case CYCLES: return "cycles";
+    case INSTRUCTIONS: return "instructions";
+    case BRANCH_MISSES: return "branch-misses";
+    case CACHE_MISSES: return "cache-misses";
+  }
+  return "unknown";
+}
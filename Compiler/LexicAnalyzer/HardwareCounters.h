@@ -0,0 +1,66 @@
+#ifndef HARDWARECOUNTERS
+#define HARDWARECOUNTERS
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// CPU event counts of the calling thread in user space, through Linux
+// perf_event_open. The counters run from construction on and a region is
+// measured as the difference of two Read()s. Counters the kernel, the CPU
+// or a container does not allow read 0, and elsewhere than on Linux none
+// is available; either way nothing throws.
+class HardwareCounters {
+ public:
+  enum Counter : uint8_t {
+    CYCLES,
+    INSTRUCTIONS,
+    BRANCH_MISSES,
+    CACHE_MISSES
+  };
+  static constexpr size_t kCounterCount = 4;
+
+  struct Sample {
+    std::array<uint64_t, kCounterCount> values{};
+
+    uint64_t operator[](Counter counter) const { return values[counter]; }
+    Sample operator-(const Sample& other) const {
+      Sample difference;
+      for (size_t i = 0; i < kCounterCount; ++i) {
+        difference.values[i] = values[i] - other.values[i];
+      }
+      return difference;
+    }
+    Sample& operator+=(const Sample& other) {
+      for (size_t i = 0; i < kCounterCount; ++i) values[i] += other.values[i];
+      return *this;
+    }
+  };
+
+  HardwareCounters();
+  ~HardwareCounters();
+  HardwareCounters(const HardwareCounters&) = delete;
+  HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+  bool IsAvailable() const;
+  bool IsAvailable(Counter counter) const;
+  // Why the first counter that is not available is not, empty when all are.
+  const std::string& GetError() const;
+  // Counts since construction, scaled up when the kernel had to share the
+  // hardware with other events. One system call.
+  Sample Read() const;
+
+  static const char* GetName(Counter counter);
+
+ private:
+  // All counters are read together through the first one opened.
+  int group_;
+  std::array<int, kCounterCount> files_;
+  // Counters in the order the group reads them.
+  std::array<Counter, kCounterCount> order_;
+  size_t opened_;
+  std::string error_;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef HASH
+#define HASH
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 64-bit hash of whole files, eight bytes per multiply. Not cryptographic:
+// it tells apart contents, nobody is expected to forge collisions.
+inline uint64_t HashBytes(const char* data, size_t size, uint64_t seed = 0) {
+  const uint64_t kMultiplier = 0x9E3779B97F4A7C15ull;
+  uint64_t hash = (seed ^ size) * kMultiplier;
+  for (; size >= 8; data += 8, size -= 8) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    hash = (hash ^ word) * kMultiplier;
+    hash ^= hash >> 29;
+  }
+  if (size != 0) {
+    uint64_t word = 0;
+    std::memcpy(&word, data, size);
+    hash = (hash ^ word) * kMultiplier;
+  }
+  hash ^= hash >> 32;
+  hash *= 0xBF58476D1CE4E5B9ull;
+  return hash ^ (hash >> 29);
+}
+
+#endif
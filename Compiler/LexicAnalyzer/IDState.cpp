@@ -1,21 +1,25 @@
 #include "IDState.h"
 #include "LexicAnalyzer.h"
+#include "UnicodeClasses.h"
 
 IDState::IDState(LexicAnalyzer* fsm) : state_machine_(fsm) {}
 
 void IDState::Execute() {
-  if (iswalnum(state_machine_->Peek()) || state_machine_->Peek() == L'_') {
+  // ASCII in runs, anything else a character at a time.
+  for (;;) {
+    state_machine_->AddIdentifierRunToBuffer();
+    if (!UnicodeClasses::IsIdentifierContinue(state_machine_->Peek())) break;
     state_machine_->AddNextCharToBuffer();
-    return;
-  } 
-  if (state_machine_->IsReserved(state_machine_->GetBuffer())) {
-    if (state_machine_->IsOperator(state_machine_->GetBuffer())) {
+  }
+  std::string_view buffer = state_machine_->GetBuffer();
+  if (state_machine_->IsReserved(buffer)) {
+    if (state_machine_->IsOperator(buffer)) {
       state_machine_->AddBufferToQueue(Token::Type::OPERATOR);
       goto change_state;
     } 
     state_machine_->AddBufferToQueue(Token::Type::RESERVED);
     goto change_state;
   } 
-  state_machine_->AddBufferToQueue(Token::Type::IDENTIFIER);
+  state_machine_->AddIdentifierToQueue();
   change_state: state_machine_->ChangeState(state_machine_->GetBeginState());
 }
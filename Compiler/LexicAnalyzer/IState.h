@@ -1,6 +1,9 @@
 #ifndef ISTATE
 #define ISTATE
 
+// A state of LexicAnalyzer's state machine; Execute() takes one step.
+// The analyzer calls each state by its concrete type, whose Execute() is
+// final, so it never goes through the vtable; the call itself remains.
 class IState {
  public:
   virtual void Execute() = 0;
@@ -0,0 +1,252 @@
+#include "IncrementalLexer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "SourceBuffer.h"
+#include "Utf8.h"
+
+namespace {
+
+// Owned symbols of removed tokens are only freed by a compaction, which
+// is not worth it for a few of them.
+const size_t kMinDeadBytes = Arena::kDefaultBlockSize;
+
+// First index in [0, count) that is_before is false for; it must be true
+// for all the indices before that one.
+template <typename IsBefore>
+size_t PartitionPoint(size_t count, IsBefore is_before) {
+  size_t first = 0;
+  while (count != 0) {
+    size_t half = count / 2;
+    if (is_before(first + half)) {
+      first += half + 1;
+      count -= half + 1;
+    } else {
+      count = half;
+    }
+  }
+  return first;
+}
+
+}  // namespace
+
+IncrementalLexer::IncrementalLexer(
+    std::string_view text, std::shared_ptr<const LexerVocabulary> vocabulary,
+    LexicAnalyzer::Engine engine, std::shared_ptr<StringInterner> interner) :
+      vocabulary_(std::move(vocabulary)),
+      interner_(interner ? std::move(interner)
+                         : std::make_shared<StringInterner>()),
+      engine_(engine),
+      tail_shift_(0),
+      dead_bytes_(0) {
+  // The whole text is one insertion into an empty one.
+  Edit(0, 0, text);
+}
+
+IncrementalLexer::Change IncrementalLexer::Edit(size_t offset,
+                                                size_t removed_length,
+                                                std::string_view inserted) {
+  size_t size = text_.GetSize();
+  if (offset > size || removed_length > size - offset) {
+    throw std::runtime_error("exception thrown: edit is outside of the text");
+  }
+  if (size - removed_length + inserted.size() > UINT32_MAX) {
+    throw std::runtime_error(
+        "exception thrown: source files must be smaller than 4 GiB");
+  }
+  uint32_t delta = static_cast<uint32_t>(inserted.size() - removed_length);
+
+  // The last token that starts before the edit may end in it or look at
+  // its first character. Every token before that one is left as it is,
+  // which also keeps the lexer's state at its start, unless the edit
+  // changes the character that token starts with: the one before may then
+  // take it in. ERROR tokens may be the pieces of a UTF-8 sequence that the
+  // edit completes, so the token before all of them is re-lexed too. An
+  // error may be reported right at the end of its ERROR token, so
+  // restarting after one would make it unclear which token a diagnostic
+  // belongs to.
+  size_t first = PartitionPoint(tokens_.GetSize(), [this, offset](size_t i) {
+    return GetOffset(i) < offset;
+  });
+  if (first != 0) --first;
+  if (first != 0) {
+    // The character may reach across the gap.
+    uint32_t start = GetOffset(first);
+    char character[4] = {};
+    size_t length = std::min<size_t>(sizeof(character), size - start);
+    for (size_t i = 0; i < length; ++i) character[i] = text_[start + i];
+    if (offset < start + Utf8SequenceLength(character, character + length)) {
+      --first;
+    }
+  }
+  while (first != 0 && tokens_[first].token.type == Token::Type::ERROR) {
+    --first;
+  }
+  while (first != 0 && tokens_[first - 1].token.type == Token::Type::ERROR) {
+    --first;
+  }
+  uint32_t restart = first != 0 ? GetOffset(first) : 0;
+
+  // The gap ends up in front of the re-lexed text, so that is in one piece.
+  text_.MoveGap(offset);
+  text_.Erase(removed_length);
+  text_.Insert(inserted.begin(), inserted.end());
+  text_.MoveGap(restart);
+  size = text_.GetSize();
+
+  #pragma region RELEX
+  std::vector<StoredToken> tokens;
+  std::vector<Diagnostic> diagnostics;
+  size_t resync = tokens_.GetSize();
+  bool is_resynced = false;
+  uint32_t resync_offset = 0;
+  size_t edit_end = offset + inserted.size();
+  {
+    const char* tail = text_.GetTail();
+    LexicAnalyzer analyzer(SourceBuffer::View(tail, size - restart),
+                           vocabulary_, engine_, 1, interner_);
+    analyzer.SetMaxErrors(SIZE_MAX);
+    size_t candidate = first;
+    StoredToken stored = {};
+    while (analyzer.NextToken(stored.token)) {
+      Token& token = stored.token;
+      const char* begin = tail + token.offset;
+      token.offset += restart;
+      if (token.offset >= edit_end) {
+        // A token behind the edit that starts where an old one started
+        // sees the same text in the same state, so does every later one.
+        uint32_t old_offset = token.offset - delta;
+        while (candidate < tokens_.GetSize() &&
+               GetOffset(candidate) < old_offset) {
+          ++candidate;
+        }
+        if (candidate < tokens_.GetSize() &&
+            GetOffset(candidate) == old_offset &&
+            (candidate == 0 ||
+             tokens_[candidate - 1].token.type != Token::Type::ERROR) &&
+            (tokens.empty() ||
+             tokens.back().token.type != Token::Type::ERROR)) {
+          resync = candidate;
+          is_resynced = true;
+          resync_offset = token.offset;
+          break;
+        }
+      }
+      uintptr_t address = reinterpret_cast<uintptr_t>(token.symbol.data());
+      stored.symbol_start = 0;
+      stored.symbol_size = 0;
+      if (token.symbol.empty()) {
+        token.symbol = std::string_view();
+      } else if (address >= reinterpret_cast<uintptr_t>(tail) &&
+                 address < reinterpret_cast<uintptr_t>(tail + size -
+                                                       restart)) {
+        stored.symbol_start = static_cast<uint32_t>(token.symbol.data() -
+                                                    begin);
+        stored.symbol_size = static_cast<uint32_t>(token.symbol.size());
+        token.symbol = std::string_view();
+      } else {
+        token.symbol = symbols_.Copy(token.symbol);
+      }
+      tokens.push_back(stored);
+    }
+    for (Diagnostic diagnostic : analyzer.GetDiagnostics()) {
+      diagnostic.offset += restart;
+      if (is_resynced && diagnostic.offset >= resync_offset) break;
+      diagnostics.push_back(diagnostic);
+    }
+  }
+  #pragma endregion RELEX
+
+  #pragma region SPLICE
+  // Whatever crosses a gap is rebased on the shift from before the edit,
+  // everything left behind the gaps then moves by delta at once.
+  auto rebase = [this](uint32_t& offset, bool behind) {
+    offset = behind ? offset - tail_shift_ : offset + tail_shift_;
+  };
+  tokens_.MoveGap(first, [&rebase](StoredToken& stored, bool behind) {
+    rebase(stored.token.offset, behind);
+  });
+  for (size_t i = first; i < resync; ++i) {
+    dead_bytes_ += tokens_[i].token.symbol.size();
+  }
+  tokens_.Erase(resync - first);
+  tokens_.Insert(tokens.begin(), tokens.end());
+
+  size_t removed_begin = PartitionPoint(
+      diagnostics_.GetSize(),
+      [this, restart](size_t i) { return GetDiagnostic(i).offset < restart; });
+  size_t removed_end = diagnostics_.GetSize();
+  if (is_resynced) {
+    uint32_t old_offset = resync_offset - delta;
+    removed_end = PartitionPoint(
+        diagnostics_.GetSize(),
+        [this, old_offset](size_t i) {
+          return GetDiagnostic(i).offset < old_offset;
+        });
+  }
+  diagnostics_.MoveGap(removed_begin,
+                       [&rebase](Diagnostic& diagnostic, bool behind) {
+                         rebase(diagnostic.offset, behind);
+                       });
+  diagnostics_.Erase(removed_end - removed_begin);
+  diagnostics_.Insert(diagnostics.begin(), diagnostics.end());
+  tail_shift_ += delta;
+  #pragma endregion SPLICE
+
+  if (dead_bytes_ > kMinDeadBytes &&
+      dead_bytes_ > symbols_.GetUsedBytes() / 2) {
+    CompactOwnedSymbols();
+  }
+  return Change{first, resync - first, tokens.size()};
+}
+
+std::string_view IncrementalLexer::GetText() {
+  size_t size = text_.GetSize();
+  text_.MoveGap(size);
+  return std::string_view(size != 0 ? &text_[0] : "", size);
+}
+
+size_t IncrementalLexer::GetTokenCount() const { return tokens_.GetSize(); }
+
+Token IncrementalLexer::GetToken(size_t index) const {
+  const StoredToken& stored = tokens_[index];
+  Token token = stored.token;
+  token.offset = GetOffset(index);
+  if (stored.symbol_size != 0) {
+    // Tokens never reach across the gap, which is only ever left in front
+    // of one.
+    token.symbol = std::string_view(
+        &text_[token.offset + stored.symbol_start], stored.symbol_size);
+  }
+  return token;
+}
+
+size_t IncrementalLexer::GetDiagnosticCount() const {
+  return diagnostics_.GetSize();
+}
+
+Diagnostic IncrementalLexer::GetDiagnostic(size_t index) const {
+  Diagnostic diagnostic = diagnostics_[index];
+  if (index >= diagnostics_.GetGap()) diagnostic.offset += tail_shift_;
+  return diagnostic;
+}
+
+StringInterner& IncrementalLexer::GetInterner() { return *interner_; }
+
+uint32_t IncrementalLexer::GetOffset(size_t token) const {
+  uint32_t offset = tokens_[token].token.offset;
+  return token < tokens_.GetGap() ? offset : offset + tail_shift_;
+}
+
+void IncrementalLexer::CompactOwnedSymbols() {
+  Arena symbols;
+  for (size_t i = 0; i < tokens_.GetSize(); ++i) {
+    Token& token = tokens_[i].token;
+    if (!token.symbol.empty()) token.symbol = symbols.Copy(token.symbol);
+  }
+  symbols_ = std::move(symbols);
+  dead_bytes_ = 0;
+}
@@ -0,0 +1,89 @@
+#ifndef INCREMENTALLEXER
+#define INCREMENTALLEXER
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "Arena.h"
+#include "Diagnostic.h"
+#include "GapBuffer.h"
+#include "LexerVocabulary.h"
+#include "LexicAnalyzer.h"
+#include "StringInterner.h"
+#include "Token.h"
+
+// Keeps the tokens of a text that is edited in place, e.g. an editor
+// buffer. An edit is re-lexed from the last token that starts before it
+// until the new tokens line up with the old ones again, so the lexing work
+// depends on the size of the edit and not of the text. Errors never throw,
+// they are recorded as with LexicAnalyzer::SetMaxErrors() without a limit.
+// The text, tokens and diagnostics are gap buffers with their gaps at the
+// last edit, and whatever lies behind a gap keeps its offset relative to
+// one shift shared by all of them, so the rest of the work depends on the
+// distance to the previous edit and not on the size of the text either.
+class IncrementalLexer {
+ public:
+  // Which tokens the last edit replaced: removed_tokens tokens starting at
+  // first_token are now inserted_tokens others.
+  struct Change {
+    size_t first_token;
+    size_t removed_tokens;
+    size_t inserted_tokens;
+  };
+
+  // Creates its own interner when none is given.
+  IncrementalLexer(std::string_view text,
+                   std::shared_ptr<const LexerVocabulary> vocabulary,
+                   LexicAnalyzer::Engine engine =
+                       LexicAnalyzer::Engine::STATE_MACHINE,
+                   std::shared_ptr<StringInterner> interner = nullptr);
+
+  // Replaces removed_length bytes at offset with inserted. Throws when the
+  // range is outside of the text or the text would reach 4 GiB.
+  Change Edit(size_t offset, size_t removed_length,
+              std::string_view inserted);
+
+  // Closes the gap in the text, which costs as much as the text when it
+  // was edited since the last call.
+  std::string_view GetText();
+  size_t GetTokenCount() const;
+  // The symbol points into the text or into storage owned by this object
+  // until the next Edit() or GetText().
+  Token GetToken(size_t index) const;
+  // Sorted by offset.
+  size_t GetDiagnosticCount() const;
+  Diagnostic GetDiagnostic(size_t index) const;
+  StringInterner& GetInterner();
+
+ private:
+  // A symbol that is a piece of the text is kept as where it starts
+  // relative to the token, since the text moves; token.symbol is only set
+  // for those in symbols_.
+  struct StoredToken {
+    Token token;
+    uint32_t symbol_start;
+    uint32_t symbol_size;
+  };
+
+  uint32_t GetOffset(size_t token) const;
+  void CompactOwnedSymbols();
+
+  std::shared_ptr<const LexerVocabulary> vocabulary_;
+  std::shared_ptr<StringInterner> interner_;
+  LexicAnalyzer::Engine engine_;
+  GapBuffer<char> text_;
+  GapBuffer<StoredToken> tokens_;
+  GapBuffer<Diagnostic> diagnostics_;
+  // Added to the offsets of the tokens and diagnostics behind the gaps,
+  // wrapping around.
+  uint32_t tail_shift_;
+  // Symbols that are not a piece of the text, such as literals with
+  // escape sequences.
+  Arena symbols_;
+  // Bytes in symbols_ no token points to any more.
+  size_t dead_bytes_;
+};
+
+#endif
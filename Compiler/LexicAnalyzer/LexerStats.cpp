@@ -0,0 +1,248 @@
+#include "LexerStats.h"
+
+#include <cstdio>
+#include <utility>
+
+namespace {
+
+// Fixed-width columns for WriteText(), the name left-aligned.
+std::string FormatRow(const std::string& name,
+                      const std::vector<std::string>& columns) {
+  char column[32];
+  std::snprintf(column, sizeof(column), "%-18s", name.c_str());
+  std::string row = column;
+  for (const std::string& text : columns) {
+    std::snprintf(column, sizeof(column), "%14s", text.c_str());
+    row += column;
+  }
+  row += '\n';
+  return row;
+}
+
+std::string FormatDouble(double number, const char* format) {
+  char text[32];
+  std::snprintf(text, sizeof(text), format, number);
+  return text;
+}
+
+std::string FormatSeconds(double seconds) {
+  return FormatDouble(seconds, "%.6f");
+}
+
+// JSON string contents; errors come from strerror().
+std::string EscapeJson(const std::string& text) {
+  std::string escaped;
+  for (char symbol : text) {
+    if (symbol == '"' || symbol == '\\') escaped += '\\';
+    escaped += symbol;
+  }
+  return escaped;
+}
+
+}  // namespace
+
+void LexerStats::AddPhase(Phase phase) { phases_.push_back(std::move(phase)); }
+
+void LexerStats::SetProfile(const HardwareCounters& counters) {
+  is_profiled_ = true;
+  for (size_t i = 0; i < HardwareCounters::kCounterCount; ++i) {
+    has_counter_[i] =
+        counters.IsAvailable(static_cast<HardwareCounters::Counter>(i));
+  }
+  counter_error_ = counters.GetError();
+}
+
+uint64_t LexerStats::GetSteps(State state) const {
+  return steps_[static_cast<size_t>(state)];
+}
+
+uint64_t LexerStats::GetBytes(State state) const {
+  return bytes_[static_cast<size_t>(state)];
+}
+
+uint64_t LexerStats::GetTokens(Token::Type type) const {
+  return tokens_[static_cast<size_t>(type)];
+}
+
+const HardwareCounters::Sample& LexerStats::GetCounters(State state) const {
+  return counters_[static_cast<size_t>(state)];
+}
+
+const std::vector<LexerStats::Phase>& LexerStats::GetPhases() const {
+  return phases_;
+}
+
+void LexerStats::WriteText(std::ostream& output) const {
+  std::vector<std::string> header = {"seconds"};
+  if (kEnabled) header.push_back("allocations");
+  output << FormatRow("phase", header);
+  for (const Phase& phase : phases_) {
+    std::vector<std::string> columns = {FormatSeconds(phase.seconds)};
+    if (kEnabled) columns.push_back(std::to_string(phase.allocations));
+    output << FormatRow(phase.name, columns);
+  }
+  if (is_profiled_) {
+    if (!counter_error_.empty()) {
+      output << "\nhardware counters: " << counter_error_ << '\n';
+    }
+    std::vector<std::string> names;
+    for (size_t i = 0; i < HardwareCounters::kCounterCount; ++i) {
+      if (!has_counter_[i]) continue;
+      names.push_back(
+          HardwareCounters::GetName(static_cast<HardwareCounters::Counter>(i)));
+    }
+    if (!names.empty()) {
+      output << '\n' << FormatRow("phase", names);
+      for (const Phase& phase : phases_) {
+        WriteCounterRows(output, phase.name.c_str(), phase.counters,
+                         phase.bytes, phase.tokens);
+      }
+      if (IsStateProfiled()) {
+        output << '\n' << FormatRow("state", names);
+        for (size_t state = 0; state < kStateCount; ++state) {
+          WriteCounterRows(output, GetStateName(static_cast<State>(state)),
+                           counters_[state], bytes_[state], 0);
+        }
+      }
+    }
+  }
+  if (!kEnabled) {
+    output << "per-state counters need a build with LEXER_STATS defined\n";
+    return;
+  }
+  output << '\n' << FormatRow("state", {"transitions", "bytes"});
+  for (size_t state = 0; state < kStateCount; ++state) {
+    output << FormatRow(GetStateName(static_cast<State>(state)),
+                        {std::to_string(steps_[state]),
+                         std::to_string(bytes_[state])});
+  }
+  output << '\n' << FormatRow("token type", {"tokens"});
+  for (size_t type = 0; type < kTypeCount; ++type) {
+    output << FormatRow(GetTypeName(static_cast<Token::Type>(type)),
+                        {std::to_string(tokens_[type])});
+  }
+}
+
+void LexerStats::WriteJson(std::ostream& output) const {
+  output << "{\"enabled\": " << (kEnabled ? "true" : "false");
+  if (is_profiled_ && !counter_error_.empty()) {
+    output << ", \"counters_error\": \"" << EscapeJson(counter_error_)
+           << '"';
+  }
+  output << ", \"phases\": [";
+  for (size_t i = 0; i < phases_.size(); ++i) {
+    // Phase names are the CLI's own, nothing to escape.
+    output << (i == 0 ? "" : ", ") << "{\"name\": \"" << phases_[i].name
+           << "\", \"seconds\": " << FormatSeconds(phases_[i].seconds);
+    if (kEnabled) output << ", \"allocations\": " << phases_[i].allocations;
+    if (is_profiled_) {
+      WriteCounterJson(output, phases_[i].counters, phases_[i].bytes,
+                       phases_[i].tokens);
+    }
+    output << '}';
+  }
+  output << ']';
+  if (kEnabled) {
+    output << ", \"states\": {";
+    for (size_t state = 0; state < kStateCount; ++state) {
+      output << (state == 0 ? "" : ", ") << '"'
+             << GetStateName(static_cast<State>(state))
+             << "\": {\"transitions\": " << steps_[state]
+             << ", \"bytes\": " << bytes_[state];
+      if (IsStateProfiled()) {
+        WriteCounterJson(output, counters_[state], bytes_[state], 0);
+      }
+      output << '}';
+    }
+    output << "}, \"tokens\": {";
+    for (size_t type = 0; type < kTypeCount; ++type) {
+      output << (type == 0 ? "" : ", ") << '"'
+             << GetTypeName(static_cast<Token::Type>(type))
+             << "\": " << tokens_[type];
+    }
+    output << '}';
+  }
+  output << "}\n";
+}
+
+const char* LexerStats::GetStateName(State state) {
+  switch (state) {
+    case State::BEGIN: return "begin";
+    case State::OPERATOR: return "operator";
+    case State::IDENTIFIER: return "identifier";
+    case State::LITERAL: return "literal";
+    case State::NUMBER: return "number";
+    case State::TABLE: return "table";
+  }
+  return "unknown";
+}
+
+const char* LexerStats::GetTypeName(Token::Type type) {
+  // As in the token output.
+  switch (type) {
+    case Token::Type::RESERVED: return "RESERVED";
+    case Token::Type::IDENTIFIER: return "IDENTIFIER";
+    case Token::Type::NUMCONSTANT: return "NUMERIC_CONSTANT";
+    case Token::Type::LITCONSTANT: return "LITERAL_CONSTANT";
+    case Token::Type::OPERATOR: return "OPERATOR";
+    case Token::Type::PUNCTUATION: return "PUNCTUATION";
+    case Token::Type::ERROR: return "ERROR";
+  }
+  return "UNKNOWN";
+}
+
+bool LexerStats::IsStateProfiled() const {
+  for (const HardwareCounters::Sample& counters : counters_) {
+    for (uint64_t value : counters.values) {
+      if (value != 0) return true;
+    }
+  }
+  return false;
+}
+
+void LexerStats::WriteCounterRows(std::ostream& output, const char* name,
+                                  const HardwareCounters::Sample& counters,
+                                  uint64_t bytes, uint64_t tokens) const {
+  std::vector<std::string> totals, per_byte, per_token;
+  for (size_t i = 0; i < HardwareCounters::kCounterCount; ++i) {
+    if (!has_counter_[i]) continue;
+    double value = static_cast<double>(counters.values[i]);
+    totals.push_back(std::to_string(counters.values[i]));
+    if (bytes != 0) per_byte.push_back(FormatDouble(value / bytes, "%.3f"));
+    if (tokens != 0) {
+      per_token.push_back(FormatDouble(value / tokens, "%.3f"));
+    }
+  }
+  output << FormatRow(name, totals);
+  if (bytes != 0) output << FormatRow("  per byte", per_byte);
+  if (tokens != 0) output << FormatRow("  per token", per_token);
+}
+
+void LexerStats::WriteCounterJson(std::ostream& output,
+                                  const HardwareCounters::Sample& counters,
+                                  uint64_t bytes, uint64_t tokens) const {
+  // Totals, then the same per byte and per token.
+  const char* const kGroups[] = {"counters", "per_byte", "per_token"};
+  const uint64_t divisors[] = {1, bytes, tokens};
+  for (size_t group = 0; group < 3; ++group) {
+    if (divisors[group] == 0) continue;
+    output << ", \"" << kGroups[group] << "\": {";
+    bool is_first = true;
+    for (size_t i = 0; i < HardwareCounters::kCounterCount; ++i) {
+      if (!has_counter_[i]) continue;
+      output << (is_first ? "" : ", ") << '"'
+             << HardwareCounters::GetName(
+                    static_cast<HardwareCounters::Counter>(i))
+             << "\": ";
+      if (group == 0) {
+        output << counters.values[i];
+      } else {
+        output << FormatDouble(
+            static_cast<double>(counters.values[i]) / divisors[group],
+            "%.6f");
+      }
+      is_first = false;
+    }
+    output << '}';
+  }
+}
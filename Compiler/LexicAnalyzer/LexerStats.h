@@ -0,0 +1,98 @@
+#ifndef LEXERSTATS
+#define LEXERSTATS
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "HardwareCounters.h"
+#include "Token.h"
+
+// Where lexing one source went. LexicAnalyzer::Run() counts the steps and
+// tokens of each state only in builds with LEXER_STATS defined, otherwise
+// the counters stay 0 and cost nothing; phases are timed by whoever drives
+// the analyzer, e.g. the CLI's --stats, optionally with hardware counters.
+class LexerStats {
+ public:
+#ifdef LEXER_STATS
+  static constexpr bool kEnabled = true;
+#else
+  static constexpr bool kEnabled = false;
+#endif
+
+  // The states of the state machine, and the table engine as a whole.
+  enum class State : uint8_t {
+    BEGIN,
+    OPERATOR,
+    IDENTIFIER,
+    LITERAL,
+    NUMBER,
+    TABLE
+  };
+  static constexpr size_t kStateCount = 6;
+  static constexpr size_t kTypeCount = 7;
+
+  struct Phase {
+    std::string name;
+    double seconds;
+    // Global operator new calls during the phase, when counted.
+    uint64_t allocations;
+    HardwareCounters::Sample counters;
+    // Source bytes and tokens the phase went through, 0 when not about
+    // them; the counters are also reported per byte and per token.
+    uint64_t bytes = 0;
+    uint64_t tokens = 0;
+  };
+
+  // One Execute() of state, which moved the cursor by bytes.
+  void AddStep(State state, size_t bytes) {
+    ++steps_[static_cast<size_t>(state)];
+    bytes_[static_cast<size_t>(state)] += bytes;
+  }
+  void AddToken(Token::Type type) { ++tokens_[static_cast<size_t>(type)]; }
+  void AddCounters(State state, const HardwareCounters::Sample& counters) {
+    counters_[static_cast<size_t>(state)] += counters;
+  }
+  void AddPhase(Phase phase);
+  // Reports the hardware counters that counters has, with those of the
+  // phases and, when any were added, of the states.
+  void SetProfile(const HardwareCounters& counters);
+
+  uint64_t GetSteps(State state) const;
+  uint64_t GetBytes(State state) const;
+  uint64_t GetTokens(Token::Type type) const;
+  const HardwareCounters::Sample& GetCounters(State state) const;
+  const std::vector<Phase>& GetPhases() const;
+
+  // Counters that were not collected are left out of both.
+  void WriteText(std::ostream& output) const;
+  void WriteJson(std::ostream& output) const;
+
+  static const char* GetStateName(State state);
+  static const char* GetTypeName(Token::Type type);
+
+ private:
+  bool IsStateProfiled() const;
+  // The available counters as totals, then per byte and per token unless
+  // those are 0.
+  void WriteCounterRows(std::ostream& output, const char* name,
+                        const HardwareCounters::Sample& counters,
+                        uint64_t bytes, uint64_t tokens) const;
+  void WriteCounterJson(std::ostream& output,
+                        const HardwareCounters::Sample& counters,
+                        uint64_t bytes, uint64_t tokens) const;
+
+  std::array<uint64_t, kStateCount> steps_{};
+  std::array<uint64_t, kStateCount> bytes_{};
+  std::array<uint64_t, kTypeCount> tokens_{};
+  std::array<HardwareCounters::Sample, kStateCount> counters_{};
+  std::vector<Phase> phases_;
+  bool is_profiled_ = false;
+  std::array<bool, HardwareCounters::kCounterCount> has_counter_{};
+  std::string counter_error_;
+};
+
+#endif
@@ -0,0 +1,162 @@
+#include "LexerVocabulary.h"
+
+#include <fstream>
+#include <stdexcept>
+
+#include "Hash.h"
+#include "StaticVocabulary.h"
+#include "Utf8.h"
+
+LexerVocabulary::LexerVocabulary() : use_static_vocabulary_(true) {
+  escapes_.fill(kInvalidEscape);
+  reserved_.insert(std::begin(StaticVocabulary::kReserved),
+                   std::end(StaticVocabulary::kReserved));
+  operators_.insert(std::begin(StaticVocabulary::kOperators),
+                    std::end(StaticVocabulary::kOperators));
+  for (char punctuation : StaticVocabulary::kPunctuation) {
+    punctuation_.insert(std::string(1, punctuation));
+  }
+  for (const char* backslash : StaticVocabulary::kBackslashes) {
+    escapes_[static_cast<unsigned char>(backslash[0])] =
+        static_cast<unsigned char>(backslash[1]);
+  }
+  tables_ = std::make_unique<const TableLexer::Tables>(*this);
+  fingerprint_ = ComputeFingerprint();
+}
+
+LexerVocabulary::LexerVocabulary(const std::string& lists_directory) {
+  escapes_.fill(kInvalidEscape);
+  std::string directory = lists_directory;
+  if (!directory.empty() && directory.back() != '/' &&
+      directory.back() != '\\') {
+    directory += '/';
+  }
+  std::ifstream list_ifstream;
+
+  #pragma region OPERATORS
+  list_ifstream.open(directory + "operators.txt");
+  if (!list_ifstream.is_open()) {
+    throw std::runtime_error(
+        "exception thrown: unable to open list of operators");
+  }
+  while (list_ifstream.good()) {
+    std::string oper;
+    std::getline(list_ifstream, oper);
+    operators_.insert(oper);
+  }
+  list_ifstream.close();
+  #pragma endregion OPERATORS
+
+  #pragma region RESERVED_IDS
+  list_ifstream.open(directory + "reserved_ids.txt");
+  if (!list_ifstream.is_open()) {
+    throw std::runtime_error(
+        "exception thrown: unable to open list of reserved ids");
+  }
+  while (list_ifstream.good()) {
+    std::string id;
+    std::getline(list_ifstream, id);
+    reserved_.insert(id);
+  }
+  list_ifstream.close();
+  #pragma endregion RESERVED_IDS
+
+  #pragma region PUNCTUATIONS
+  list_ifstream.open(directory + "punctuations.txt");
+  if (!list_ifstream.is_open()) {
+    throw std::runtime_error(
+        "exception thrown: unable to open list of punctuations");
+  }
+  while (list_ifstream.good()) {
+    std::string punc;
+    std::getline(list_ifstream, punc);
+    punctuation_.insert(punc);
+  }
+  list_ifstream.close();
+  #pragma endregion PUNCTUATIONS
+
+  use_static_vocabulary_ =
+      StaticVocabulary::Matches(reserved_, operators_, punctuation_);
+
+  #pragma region BACKSLASHES
+  list_ifstream.open(directory + "backslashes.txt");
+  if (!list_ifstream.is_open()) {
+    throw std::runtime_error(
+        "exception thrown: unable to open list of backslash symbols");
+  }
+  // Pairs of bytes, the escaped character and what it stands for.
+  for (;;) {
+    std::ifstream::int_type key = list_ifstream.get();
+    std::ifstream::int_type value = list_ifstream.get();
+    if (value == std::ifstream::traits_type::eof()) break;
+    if (key >= 0x80) {
+      throw std::runtime_error(
+          "exception thrown: escaped characters must be ASCII");
+    }
+    escapes_[key] = static_cast<char32_t>(value);
+  }
+  list_ifstream.close();
+  #pragma endregion BACKSLASHES
+
+  tables_ = std::make_unique<const TableLexer::Tables>(*this);
+  fingerprint_ = ComputeFingerprint();
+}
+
+std::shared_ptr<const LexerVocabulary> LexerVocabulary::Default() {
+  // Function-local statics are initialized exactly once, even when the
+  // first calls race.
+  static const std::shared_ptr<const LexerVocabulary> vocabulary(
+      new LexerVocabulary());
+  return vocabulary;
+}
+
+bool LexerVocabulary::IsPunctuation(char32_t symbol) const {
+  if (use_static_vocabulary_) return StaticVocabulary::IsPunctuation(symbol);
+  std::string buff;
+  AppendUtf8(buff, symbol);
+  return punctuation_.find(buff) != punctuation_.end();
+}
+
+bool LexerVocabulary::IsOperator(std::string_view string) const {
+  if (use_static_vocabulary_) return StaticVocabulary::IsOperator(string);
+  return operators_.find(string) != operators_.end();
+}
+
+bool LexerVocabulary::IsReserved(std::string_view string) const {
+  if (use_static_vocabulary_) return StaticVocabulary::IsReserved(string);
+  return reserved_.find(string) != reserved_.end();
+}
+
+char32_t LexerVocabulary::ToControl(char32_t symbol) const {
+  return symbol < escapes_.size() ? escapes_[symbol] : kInvalidEscape;
+}
+
+const std::set<std::string, std::less<>>& LexerVocabulary::GetOperators()
+    const {
+  return operators_;
+}
+
+const TableLexer::Tables& LexerVocabulary::GetTables() const {
+  return *tables_;
+}
+
+uint64_t LexerVocabulary::GetFingerprint() const { return fingerprint_; }
+
+uint64_t LexerVocabulary::ComputeFingerprint() const {
+  // Sets and the escape table iterate in order, so equal lists give equal
+  // bytes.
+  std::string lists;
+  for (const auto* list : {&reserved_, &operators_, &punctuation_}) {
+    for (const std::string& entry : *list) {
+      lists += entry;
+      lists += '\n';
+    }
+    lists += '\0';
+  }
+  for (char32_t symbol = 0; symbol < escapes_.size(); ++symbol) {
+    if (escapes_[symbol] == kInvalidEscape) continue;
+    AppendUtf8(lists, symbol);
+    AppendUtf8(lists, escapes_[symbol]);
+  }
+  return HashBytes(lists.data(), lists.size());
+}
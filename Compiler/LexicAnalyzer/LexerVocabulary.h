@@ -0,0 +1,59 @@
+#ifndef LEXERVOCABULARY
+#define LEXERVOCABULARY
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+
+#include "TableLexer.h"
+
+// Reserved words, operators, punctuation and escape sequences of the
+// language, together with the tables the TABLE engine compiles from them.
+// It is never modified after construction, so one instance can be shared
+// by any number of analyzers, including analyzers running on different
+// threads, and creating an analyzer costs no list parsing at all.
+class LexerVocabulary {
+ public:
+  // Reads operators.txt, reserved_ids.txt, punctuations.txt and
+  // backslashes.txt from lists_directory.
+  explicit LexerVocabulary(const std::string& lists_directory);
+
+  // The stock lists compiled into the binary, built on first use. Does not
+  // touch the file system, so it works from any working directory.
+  static std::shared_ptr<const LexerVocabulary> Default();
+
+  bool IsPunctuation(char32_t symbol) const;
+  bool IsOperator(std::string_view string) const;
+  bool IsReserved(std::string_view string) const;
+  // The character that symbol escaped with a backslash stands for, or
+  // kInvalidEscape when backslashes.txt does not list symbol.
+  char32_t ToControl(char32_t symbol) const;
+
+  static constexpr char32_t kInvalidEscape = 0xFFFFFFFE;
+
+  const std::set<std::string, std::less<>>& GetOperators() const;
+  const TableLexer::Tables& GetTables() const;
+  // Hash of the lists' contents, so changing any list changes it.
+  uint64_t GetFingerprint() const;
+
+ private:
+  LexerVocabulary();
+
+  uint64_t ComputeFingerprint() const;
+
+  std::set<std::string, std::less<>> reserved_;
+  std::set<std::string, std::less<>> operators_;
+  std::set<std::string, std::less<>> punctuation_;
+  // By escaped character, which is ASCII; kInvalidEscape where none.
+  std::array<char32_t, 0x80> escapes_;
+  // Set when the lists above are the stock ones, lookups then go through
+  // the compiled-in perfect hash tables instead of the sets.
+  bool use_static_vocabulary_;
+  std::unique_ptr<const TableLexer::Tables> tables_;
+  uint64_t fingerprint_;
+};
+
+#endif
@@ -1,125 +1,249 @@
 #include "LexicAnalyzer.h"
 
-LexicAnalyzer::LexicAnalyzer(std::wifstream& input_stream) : 
-      input_stream_(input_stream),
-      token_buffer_(L""),
-      current_line_(1),
-      current_character_(0),
+#include <algorithm>
+
+#include "Scanner.h"
+#include "Utf8.h"
+
+namespace {
+
+// Most non-ASCII text is well-formed, checking it once per window instead
+// of per character leaves decoding just the lead byte's length.
+const ptrdiff_t kValidationWindow = 1 << 14;
+
+// Operator-heavy code has fewer, most sources have more; an estimate that
+// is short grows like any vector.
+const ptrdiff_t kBytesPerToken = 4;
+
+}  // namespace
+
+LexicAnalyzer::LexicAnalyzer(std::wifstream& input_stream) :
+      LexicAnalyzer(SourceBuffer(input_stream)) {}
+
+LexicAnalyzer::LexicAnalyzer(SourceBuffer source, Engine engine) :
+      LexicAnalyzer(std::move(source), LexerVocabulary::Default(), engine) {}
+
+LexicAnalyzer::LexicAnalyzer(
+    SourceBuffer source, std::shared_ptr<const LexerVocabulary> vocabulary,
+    Engine engine, size_t first_line,
+    std::shared_ptr<StringInterner> interner) :
+      vocabulary_(std::move(vocabulary)),
+      interner_(interner ? std::move(interner)
+                         : std::make_shared<StringInterner>()),
+      interner_cache_(interner_.get()),
+      source_(std::move(source)),
+      cursor_(source_.Begin()),
+      end_(source_.End()),
+      valid_end_(source_.Begin()),
+      token_begin_(nullptr),
+      token_start_(source_.Begin()),
+      token_length_(0),
+      is_buffer_owned_(false),
+      token_buffer_(""),
+      next_token_(0),
+      line_index_(source_.Begin(), source_.End(), first_line),
+      max_errors_(0),
       begin_state_(this),
       operator_state_(this),
       id_state_(this),
       lit_const_state_(this),
       number_state_(this),
-      current_state_(&begin_state_) {
-  std::wifstream list_ifstream;
-
-  #pragma region OPERATORS
-  list_ifstream.open("lists/operators.txt");
-  if (!list_ifstream.is_open()) {
+      state_(StateId::BEGIN),
+      engine_(engine),
+      table_lexer_(this, &vocabulary_->GetTables()),
+      profiler_(nullptr) {
+  if (source_.Size() > UINT32_MAX) {
     throw std::runtime_error(
-        "exception thrown: unable to open list of operators");
+        "exception thrown: source files must be smaller than 4 GiB");
   }
-  while (list_ifstream.good()) {
-    std::wstring oper;
-    std::getline(list_ifstream, oper);
-    operators_.insert(oper);
-  }
-  list_ifstream.close();
-  #pragma endregion OPERATORS
+}
 
-  #pragma region RESERVED_IDS
-  list_ifstream.open("lists/reserved_ids.txt");
-  if (!list_ifstream.is_open()) {
-    throw std::runtime_error(
-        "exception thrown: unable to open list of reserved ids");
-  }
-  while (list_ifstream.good()) {
-    std::wstring id;
-    std::getline(list_ifstream, id);
-    reserved_.insert(id);
-  }
-  list_ifstream.close();
-  #pragma endregion RESERVED_IDS
+void LexicAnalyzer::SetMaxErrors(size_t max_errors) {
+  max_errors_ = max_errors;
+}
 
-  #pragma region PUNCTUATIONS
-  list_ifstream.open("lists/punctuations.txt");
-  if (!list_ifstream.is_open()) {
-    throw std::runtime_error(
-        "exception thrown: unable to open list of punctuations");
-  }
-  while (list_ifstream.good()) {
-    std::wstring punc;
-    std::getline(list_ifstream, punc);
-    punctuation_.insert(punc);
-  }
-  list_ifstream.close();
-  #pragma endregion PUNCTUATIONS
+const std::vector<Diagnostic>& LexicAnalyzer::GetDiagnostics() const {
+  return diagnostics_;
+}
 
-  #pragma region BACKSLASHES
-  list_ifstream.open("lists/backslashes.txt");
-  if (!list_ifstream.is_open()) {
-    throw std::runtime_error(
-        "exception thrown: unable to open list of backslash symbols");
-  }
-  while (list_ifstream.good()) {
-    wchar_t key = list_ifstream.get();
-    wchar_t value = list_ifstream.get();
-    backslashes_.insert({key, value});
-  }
-  list_ifstream.close();
-  #pragma endregion BACKSLASHES
+std::string LexicAnalyzer::FormatDiagnostic(const Diagnostic& diagnostic) {
+  return FormatError(diagnostic.message, diagnostic.offset);
 }
 
-void LexicAnalyzer::ChangeState(IState* state) {
-  current_state_ = state; 
+void LexicAnalyzer::ChangeState(BeginState*) { state_ = StateId::BEGIN; }
+
+void LexicAnalyzer::ChangeState(OperatorState*) {
+  state_ = StateId::OPERATOR;
 }
 
-wchar_t LexicAnalyzer::Peek() { return input_stream_.peek(); }
+void LexicAnalyzer::ChangeState(IDState*) { state_ = StateId::IDENTIFIER; }
+
+void LexicAnalyzer::ChangeState(LitConstState*) {
+  state_ = StateId::LITERAL;
+}
+
+void LexicAnalyzer::ChangeState(NumberState*) { state_ = StateId::NUMBER; }
+
+char32_t LexicAnalyzer::Peek() {
+  if (cursor_ == end_) return kEndOfSource;
+  if (static_cast<unsigned char>(*cursor_) < 0x80) return *cursor_;
+  if (IsValidUtf8()) return DecodeValidUtf8(cursor_);
+  return DecodeUtf8(cursor_, end_);
+}
 
 void LexicAnalyzer::SkipChar() { 
-  wchar_t peek = input_stream_.peek();
-  if (peek == '\n') {
-    ++current_line_;
-    current_character_ = 0;
-  }
-  else ++current_character_;
-  input_stream_.get();
+  if (!HasNext()) return;
+  cursor_ += GetCharLength();
 }
 
 void LexicAnalyzer::SkipLine() { 
-  std::wstring tmp;
-  std::getline(input_stream_, tmp);
-  ++current_line_;
-  current_character_ = 0;
+  const char* newline = Scanner::FindNewline(cursor_, end_);
+  cursor_ = newline != end_ ? newline + 1 : end_;
 }
 
-bool LexicAnalyzer::HasNext() {
-  input_stream_.peek();
-  return !input_stream_.eof();
+void LexicAnalyzer::SkipBlanks() {
+  cursor_ = Scanner::SkipBlanks(cursor_, end_);
 }
 
+bool LexicAnalyzer::HasNext() { return cursor_ != end_; }
+
 void LexicAnalyzer::AddNextCharToBuffer() {
-  wchar_t peek = input_stream_.peek();
-  ++current_character_;
-  token_buffer_.push_back(input_stream_.get());
+  if (!HasNext()) return;
+  AddBytesToBuffer(GetCharLength());
 }
 
-void LexicAnalyzer::AddCharToBuffer(wchar_t symbol) {
-  wchar_t peek = input_stream_.peek();
-  ++current_character_;
-  token_buffer_.push_back(symbol);
+bool LexicAnalyzer::AddIdentifierRunToBuffer() {
+  size_t length = Scanner::SkipIdentifier(cursor_, end_) - cursor_;
+  if (length == 0) return false;
+  AddBytesToBuffer(length);
+  return true;
+}
+
+bool LexicAnalyzer::AddDigitRunToBuffer() {
+  size_t length = Scanner::SkipDigits(cursor_, end_) - cursor_;
+  if (length == 0) return false;
+  AddBytesToBuffer(length);
+  return true;
+}
+
+bool LexicAnalyzer::AddStringTextToBuffer() {
+  size_t length = Scanner::SkipStringText(cursor_, end_) - cursor_;
+  if (length == 0) return false;
+  AddBytesToBuffer(length);
+  return true;
+}
+
+void LexicAnalyzer::AddBytesToBuffer(size_t length) {
+  if (is_buffer_owned_) {
+    token_buffer_.append(cursor_, length);
+  } else if (token_length_ == 0) {
+    token_begin_ = cursor_;
+    token_length_ = length;
+  } else if (token_begin_ + token_length_ == cursor_) {
+    token_length_ += length;
+  } else {
+    OwnBuffer();
+    token_buffer_.append(cursor_, length);
+  }
+  cursor_ += length;
+}
+
+void LexicAnalyzer::AddCharToBuffer(char32_t symbol) {
+  OwnBuffer();
+  AppendUtf8(token_buffer_, symbol);
+}
+
+size_t LexicAnalyzer::GetCharLength() {
+  if (static_cast<unsigned char>(*cursor_) < 0x80) return 1;
+  if (IsValidUtf8()) return ValidUtf8SequenceLength(cursor_);
+  return Utf8SequenceLength(cursor_, end_);
+}
+
+bool LexicAnalyzer::IsValidUtf8() {
+  if (cursor_ < valid_end_) return true;
+  // A window may end inside a sequence; it is validated with the next one.
+  valid_end_ = FindInvalidUtf8(
+      cursor_, cursor_ + std::min(kValidationWindow, end_ - cursor_));
+  return cursor_ < valid_end_;
 }
 
 void LexicAnalyzer::AddBufferToQueue(Token::Type token_type) {
-  current_token_queue_.push(Token{token_buffer_, token_type});
+  tokens_.Push(TakeBuffer(token_type));
+}
+
+void LexicAnalyzer::AddNumberToQueue(NumberParser::Format format) {
+  if (format == NumberParser::Format::DECIMAL) {
+    SetBuffer(NumberParser::TrimLeadingZeros(GetBuffer()));
+  }
+  Token token;
+  if (!NumberParser::Parse(GetBuffer(), format, token)) {
+    ReportError(Diagnostic::Code::NUMBER_OUT_OF_RANGE,
+                format == NumberParser::Format::REAL
+                    ? "error: real constant is out of range"
+                    : "error: integer constant is out of range");
+    return;
+  }
+  Token number = TakeBuffer(Token::Type::NUMCONSTANT);
+  number.value_type = token.value_type;
+  number.value = token.value;
+  tokens_.Push(number);
+}
+
+void LexicAnalyzer::AddIdentifierToQueue() {
+  uint32_t symbol_id = interner_cache_.Intern(GetBuffer());
+  Token identifier = TakeBuffer(Token::Type::IDENTIFIER);
+  identifier.symbol_id = symbol_id;
+  tokens_.Push(identifier);
+}
+
+Token LexicAnalyzer::TakeBuffer(Token::Type token_type) {
+  Token token{is_buffer_owned_
+                  ? symbols_.Copy(token_buffer_)
+                  : std::string_view(token_begin_, token_length_),
+              token_type};
+  token.offset = static_cast<uint32_t>(token_start_ - source_.Begin());
   token_buffer_.clear();
+  token_length_ = 0;
+  is_buffer_owned_ = false;
+  return token;
+}
+
+void LexicAnalyzer::OwnBuffer() {
+  if (is_buffer_owned_) return;
+  token_buffer_.assign(token_begin_, token_length_);
+  is_buffer_owned_ = true;
+}
+
+LineIndex::Location LexicAnalyzer::GetLocation(size_t offset) {
+  return line_index_.GetLocation(offset);
+}
+
+bool LexicAnalyzer::NextToken(Token& token) {
+  if (next_token_ == tokens_.Size()) {
+    // Streaming keeps only the tokens of one Run() at a time.
+    tokens_.Clear();
+    next_token_ = 0;
+    while (tokens_.IsEmpty() && (HasNext() || !GetBuffer().empty())) {
+      Run();
+    }
+    if (tokens_.IsEmpty()) return false;
+  }
+  token = tokens_.GetToken(next_token_++);
+  return true;
 }
 
-std::queue<Token> LexicAnalyzer::GetTokens() {
-  while (HasNext() || !token_buffer_.empty()) {
+TokenRange LexicAnalyzer::Tokens() { return TokenRange(this); }
+
+TokenBuffer LexicAnalyzer::GetTokens() {
+  tokens_.Erase(next_token_);
+  next_token_ = 0;
+  tokens_.Reserve(tokens_.Size() + (end_ - cursor_) / kBytesPerToken);
+  while (HasNext() || !GetBuffer().empty()) {
     Run();
   }
-  return current_token_queue_;
+  TokenBuffer tokens = std::move(tokens_);
+  tokens_.Clear();
+  return tokens;
 }
 
 BeginState* LexicAnalyzer::GetBeginState() { return &begin_state_; }
@@ -132,41 +256,199 @@ LitConstState* LexicAnalyzer::GetLitConstState() { return &lit_const_state_; }
 
 NumberState* LexicAnalyzer::GetNumberState() { return &number_state_; }
 
-std::wstring LexicAnalyzer::GetBuffer() { return token_buffer_; }
+StringInterner& LexicAnalyzer::GetInterner() { return *interner_; }
+
+const LexerStats& LexicAnalyzer::GetStats() const { return stats_; }
+
+void LexicAnalyzer::SetProfiler(const HardwareCounters* counters) {
+  profiler_ = counters;
+}
+
+std::string_view LexicAnalyzer::GetBuffer() {
+  if (is_buffer_owned_) return token_buffer_;
+  return std::string_view(token_begin_, token_length_);
+}
 
-void LexicAnalyzer::SetBuffer(std::wstring string) { token_buffer_ = string; }
+void LexicAnalyzer::SetBuffer(std::string_view string) {
+  // Trimming the pending span (e.g. leading zeros) keeps it a source view.
+  std::string_view current = GetBuffer();
+  if (!is_buffer_owned_ && current.size() >= string.size() &&
+      current.substr(current.size() - string.size()) == string) {
+    token_begin_ += current.size() - string.size();
+    token_length_ = string.size();
+    return;
+  }
+  token_buffer_.assign(string);
+  is_buffer_owned_ = true;
+}
 
-bool LexicAnalyzer::IsPunctuation(wchar_t symbol) {
-  std::wstring buff(1, symbol);
-  return punctuation_.find(buff) != punctuation_.end();
+bool LexicAnalyzer::IsPunctuation(char32_t symbol) {
+  return vocabulary_->IsPunctuation(symbol);
 }
 
-bool LexicAnalyzer::IsOperator(std::wstring string) {
-  return operators_.find(string) != operators_.end();
+bool LexicAnalyzer::IsOperator(std::string_view string) {
+  return vocabulary_->IsOperator(string);
 }
 
-bool LexicAnalyzer::IsReserved(std::wstring string) {
-  return reserved_.find(string) != reserved_.end();
+bool LexicAnalyzer::IsReserved(std::string_view string) {
+  return vocabulary_->IsReserved(string);
 }
 
-wchar_t LexicAnalyzer::ToControl(wchar_t symbol) {
-  return backslashes_[symbol];
+char32_t LexicAnalyzer::ToControl(char32_t symbol) {
+  return vocabulary_->ToControl(symbol);
 }
 
-void LexicAnalyzer::Run() { current_state_->Execute(); }
+void LexicAnalyzer::Run() {
+  if (engine_ == Engine::TABLE) {
+    Step(table_lexer_);
+    return;
+  }
+  if (state_ == StateId::BEGIN) {
+    // Every token starts in the begin state, which consumes its first
+    // character and hands the rest to the state of the token's kind.
+    token_start_ = cursor_;
+    Step(begin_state_);
+  }
+  switch (state_) {
+    case StateId::BEGIN:
+      break;
+    case StateId::OPERATOR:
+      RunToCompletion(operator_state_, StateId::OPERATOR);
+      break;
+    case StateId::IDENTIFIER:
+      RunToCompletion(id_state_, StateId::IDENTIFIER);
+      break;
+    case StateId::LITERAL:
+      RunToCompletion(lit_const_state_, StateId::LITERAL);
+      break;
+    case StateId::NUMBER:
+      RunToCompletion(number_state_, StateId::NUMBER);
+      break;
+  }
+}
+
+template <typename State>
+void LexicAnalyzer::Step(State& state) {
+#ifdef LEXER_STATS
+  StepStart start = StartStep();
+  state.Execute();
+  // A step that throws is not counted.
+  EndStep(start);
+#else
+  state.Execute();
+#endif
+}
+
+template <typename State>
+void LexicAnalyzer::RunToCompletion(State& state, StateId id) {
+  do {
+    Step(state);
+  } while (state_ == id);
+}
+
+#ifdef LEXER_STATS
+LexicAnalyzer::StepStart LexicAnalyzer::StartStep() const {
+  StepStart start{GetStatsState(), cursor_, tokens_.Size(), {}};
+  if (profiler_ != nullptr) start.counters = profiler_->Read();
+  return start;
+}
+
+void LexicAnalyzer::EndStep(const StepStart& start) {
+  if (profiler_ != nullptr) {
+    stats_.AddCounters(start.state, profiler_->Read() - start.counters);
+  }
+  stats_.AddStep(start.state, cursor_ - start.cursor);
+  for (size_t i = start.token_count; i < tokens_.Size(); ++i) {
+    stats_.AddToken(tokens_.GetType(i));
+  }
+}
+#endif
+
+LexerStats::State LexicAnalyzer::GetStatsState() const {
+  if (engine_ == Engine::TABLE) return LexerStats::State::TABLE;
+  switch (state_) {
+    case StateId::BEGIN: return LexerStats::State::BEGIN;
+    case StateId::OPERATOR: return LexerStats::State::OPERATOR;
+    case StateId::IDENTIFIER: return LexerStats::State::IDENTIFIER;
+    case StateId::LITERAL: return LexerStats::State::LITERAL;
+    case StateId::NUMBER: return LexerStats::State::NUMBER;
+  }
+  return LexerStats::State::BEGIN;
+}
 
 void LexicAnalyzer::ThrowException(const char* msg) { 
+  throw std::runtime_error(FormatError(msg, cursor_ - source_.Begin()));
+}
+
+void LexicAnalyzer::ReportError(Diagnostic::Code code, const char* message) {
+  if (max_errors_ == 0) ThrowException(message);
+  uint32_t offset = static_cast<uint32_t>(cursor_ - source_.Begin());
+  if (diagnostics_.size() == max_errors_) {
+    diagnostics_.push_back(Diagnostic{
+        Diagnostic::Code::TOO_MANY_ERRORS, offset,
+        "error: too many errors, the rest of the file is skipped"});
+    cursor_ = end_;
+  } else {
+    diagnostics_.push_back(Diagnostic{code, offset, message});
+    cursor_ = Resynchronize(code);
+    Token error{std::string_view(token_start_, cursor_ - token_start_),
+                Token::Type::ERROR};
+    error.offset = static_cast<uint32_t>(token_start_ - source_.Begin());
+    tokens_.Push(error);
+  }
+  token_buffer_.clear();
+  token_length_ = 0;
+  is_buffer_owned_ = false;
+  number_state_.ResetState();
+  lit_const_state_.ResetState();
+  state_ = StateId::BEGIN;
+}
+
+std::string LexicAnalyzer::FormatError(const char* message, size_t offset) {
   std::string full_error_message = "LEXIC ANALYZER ERROR!\n";
-  full_error_message += msg;
+  full_error_message += message;
   full_error_message.push_back('\n');
-  full_error_message += "at line " + std::to_string(current_line_)
-                     + " char " + std::to_string(current_character_)
+  LineIndex::Location location = GetLocation(offset);
+  full_error_message += "at line " + std::to_string(location.line)
+                     + " char " + std::to_string(location.column)
                      + " \"";
-  if (HasNext()) {
-    full_error_message.push_back(Peek());
+  const char* position = source_.Begin() + offset;
+  if (position != end_) {
+    full_error_message.append(position, Utf8SequenceLength(position, end_));
   } else {
     full_error_message += "eof";
   }
   full_error_message += "\"";
-  throw std::runtime_error(full_error_message);
+  return full_error_message;
+}
+
+const char* LexicAnalyzer::Resynchronize(Diagnostic::Code code) const {
+  const char* cursor = cursor_;
+  switch (code) {
+    case Diagnostic::Code::UNEXPECTED_SYMBOL:
+      return cursor + Utf8SequenceLength(cursor, end_);
+    case Diagnostic::Code::INVALID_CHAR_LITERAL:
+    case Diagnostic::Code::INVALID_ESCAPE:
+      // Up to and including the closing quote, the same as the opening one,
+      // if it is on this line.
+      while (cursor != end_ && *cursor != '\n') {
+        if (*cursor == *token_start_) return cursor + 1;
+        if (*cursor == '\\' && cursor + 1 != end_ && cursor[1] != '\n') {
+          ++cursor;
+        }
+        ++cursor;
+      }
+      return cursor;
+    case Diagnostic::Code::MALFORMED_NUMBER:
+      // The rest of what looks like a number or a word, dots included.
+      for (;;) {
+        cursor = Scanner::SkipIdentifier(cursor, end_);
+        if (cursor == end_ || *cursor != '.') return cursor;
+        ++cursor;
+      }
+    default:
+      // The text is already consumed: an unterminated literal stops at the
+      // end of its line, an out of range number right after itself.
+      return cursor;
+  }
 }
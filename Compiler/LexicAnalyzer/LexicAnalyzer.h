@@ -2,71 +2,210 @@
 #define LEXICANALYZER
 
 #include <fstream>
-#include <queue>
+#include <memory>
 #include <string>
-#include <set>
-#include <map>
+#include <string_view>
 #include <exception>
+#include <vector>
 
+#include "Arena.h"
+#include "Diagnostic.h"
 #include "Token.h"
+#include "TokenBuffer.h"
+#include "SourceBuffer.h"
+#include "TokenIterator.h"
 #include "IState.h"
 #include "BeginState.h"
 #include "OperatorState.h"
 #include "IDState.h"
 #include "LitConstState.h"
 #include "NumberState.h"
+#include "NumberParser.h"
+#include "TableLexer.h"
+#include "LexerVocabulary.h"
+#include "LexerStats.h"
+#include "StringInterner.h"
+#include "LineIndex.h"
 
 class LexicAnalyzer {
  public:
+  enum class Engine {
+    STATE_MACHINE,
+    TABLE
+  };
+
   LexicAnalyzer(std::wifstream& input_stream);
+  // Use LexerVocabulary::Default().
+  explicit LexicAnalyzer(SourceBuffer source,
+                         Engine engine = Engine::STATE_MACHINE);
+  // first_line numbers the first line of source in error messages and
+  // locations, for sources that are a slice of a larger file. Sources must
+  // be smaller than 4 GiB, token offsets are 32-bit. Analyzers given the same
+  // interner give the same identifiers the same symbol_id; without one the
+  // analyzer creates its own.
+  LexicAnalyzer(SourceBuffer source,
+                std::shared_ptr<const LexerVocabulary> vocabulary,
+                Engine engine = Engine::STATE_MACHINE, size_t first_line = 1,
+                std::shared_ptr<StringInterner> interner = nullptr);
+
+  // With max_errors 0, the default, the first error throws. Otherwise each
+  // error is recorded as a Diagnostic, the text up to a point where lexing
+  // can resume is queued as an ERROR token, and lexing goes on; after
+  // max_errors errors the rest of the source is skipped. Call it before
+  // taking any token.
+  void SetMaxErrors(size_t max_errors);
+  const std::vector<Diagnostic>& GetDiagnostics() const;
+  std::string FormatDiagnostic(const Diagnostic& diagnostic);
 
-  void ChangeState(IState* state);
-  wchar_t Peek();
+  // Returned by Peek() at the end of the source, in no character class.
+  static constexpr char32_t kEndOfSource = 0xFFFFFFFF;
+
+  // One overload per state, so that Run() dispatches with a switch and
+  // direct calls instead of a virtual call per character.
+  void ChangeState(BeginState* state);
+  void ChangeState(OperatorState* state);
+  void ChangeState(IDState* state);
+  void ChangeState(LitConstState* state);
+  void ChangeState(NumberState* state);
+  char32_t Peek();
   void SkipChar();
   void SkipLine();
+  void SkipBlanks();
   bool HasNext();
 
   void AddNextCharToBuffer();
-  void AddCharToBuffer(wchar_t symbol);
+  void AddCharToBuffer(char32_t symbol);
+  // Bulk versions of AddNextCharToBuffer for runs of ASCII identifier
+  // characters or digits, return false when the next character starts none.
+  bool AddIdentifierRunToBuffer();
+  bool AddDigitRunToBuffer();
+  // The same for the text of a string literal, see Scanner::SkipStringText.
+  bool AddStringTextToBuffer();
   void AddBufferToQueue(Token::Type token_type);
+  // Queues the buffer as a NUMCONSTANT carrying its value; decimal integers
+  // lose their leading zeros. Throws when the value is out of range.
+  void AddNumberToQueue(NumberParser::Format format);
+  // Queues the buffer as an IDENTIFIER carrying its interned symbol_id.
+  void AddIdentifierToQueue();
+
+  // Line and column of a byte offset into the source, e.g. Token::offset.
+  LineIndex::Location GetLocation(size_t offset);
 
-  std::queue<Token> GetTokens();
+  bool NextToken(Token& token);
+  TokenRange Tokens();
+  // The remaining tokens, in a buffer reserved from the size of the rest of
+  // the source.
+  TokenBuffer GetTokens();
   BeginState* GetBeginState();
   OperatorState* GetOperatorState();
   IDState* GetIDState();
   LitConstState* GetLitConstState();
   NumberState* GetNumberState();
-  std::wstring GetBuffer();
-  void SetBuffer(std::wstring string);
+  StringInterner& GetInterner();
+  // Counters of the tokens lexed so far; see LexerStats.
+  const LexerStats& GetStats() const;
+  // In LEXER_STATS builds, adds the hardware counters of every step to its
+  // state in GetStats(). Reading them twice a step costs far more than the
+  // step, so only compare the states with each other. Null stops it.
+  void SetProfiler(const HardwareCounters* counters);
+  std::string_view GetBuffer();
+  void SetBuffer(std::string_view string);
 
-  bool IsPunctuation(wchar_t symbol);
-  bool IsOperator(std::wstring string);
-  bool IsReserved(std::wstring string);
-  wchar_t ToControl(wchar_t symbol);
+  bool IsPunctuation(char32_t symbol);
+  bool IsOperator(std::string_view string);
+  bool IsReserved(std::string_view string);
+  char32_t ToControl(char32_t symbol);
 
   void ThrowException(const char* message);
+  // Throws like ThrowException() or, when recovering, records the error
+  // and resets the analyzer to the begin state; the caller must return
+  // right after.
+  void ReportError(Diagnostic::Code code, const char* message);
 
  private:
-  void Run();
+  friend class TableLexer;
+
+  enum class StateId : uint8_t {
+    BEGIN,
+    OPERATOR,
+    IDENTIFIER,
+    LITERAL,
+    NUMBER
+  };
 
+#ifdef LEXER_STATS
+  // Where a step started, for stats_.
+  struct StepStart {
+    LexerStats::State state;
+    const char* cursor;
+    size_t token_count;
+    HardwareCounters::Sample counters;
+  };
+  StepStart StartStep() const;
+  void EndStep(const StepStart& start);
+#endif
 
-  size_t current_line_;
-  size_t current_character_;
+  // Lexes one token, or skips what is between two.
+  void Run();
+  // Every state's Execute() is final, so these call it directly instead of
+  // through the vtable. The bodies are in the states' own files, so each
+  // step is still an ordinary call unless the build optimizes across them.
+  template <typename State>
+  void Step(State& state);
+  // Steps state until it hands the source back to another one, normally
+  // at the end of its token.
+  template <typename State>
+  void RunToCompletion(State& state, StateId id);
+  void OwnBuffer();
+  void AddBytesToBuffer(size_t length);
+  // Bytes in the character at cursor_, which must not be the end.
+  size_t GetCharLength();
+  // Whether cursor_ is in a stretch known to be well-formed UTF-8.
+  bool IsValidUtf8();
+  // The buffer as a token of the given type, after which it is empty.
+  Token TakeBuffer(Token::Type token_type);
+  std::string FormatError(const char* message, size_t offset);
+  // Where lexing resumes after an error of the given kind at cursor_.
+  const char* Resynchronize(Diagnostic::Code code) const;
+  LexerStats::State GetStatsState() const;
 
-  std::set<std::wstring> reserved_;
-  std::set<std::wstring> operators_;
-  std::set<std::wstring> punctuation_;
-  std::map<wchar_t, wchar_t> backslashes_;
+  std::shared_ptr<const LexerVocabulary> vocabulary_;
+  std::shared_ptr<StringInterner> interner_;
+  StringInterner::Cache interner_cache_;
 
-  std::wifstream& input_stream_;
-  std::wstring token_buffer_;
-  std::queue<Token> current_token_queue_;
+  SourceBuffer source_;
+  const char* cursor_;
+  const char* end_;
+  // Validated ahead of cursor_ in bulk, a window at a time, the first time
+  // a non-ASCII character is reached after the last window.
+  const char* valid_end_;
+  // The pending token is a span of the source until some of its text stops
+  // matching the input (escapes, normalization); only then it is copied
+  // into token_buffer_, and only such tokens keep a copy in symbols_, which
+  // frees them all together with the analyzer.
+  const char* token_begin_;
+  // Where the pending token starts in the source, quotes included.
+  const char* token_start_;
+  size_t token_length_;
+  bool is_buffer_owned_;
+  std::string token_buffer_;
+  Arena symbols_;
+  TokenBuffer tokens_;
+  // Tokens before it were taken by NextToken().
+  size_t next_token_;
+  LineIndex line_index_;
+  size_t max_errors_;
+  std::vector<Diagnostic> diagnostics_;
   BeginState begin_state_;
   OperatorState operator_state_;
   IDState id_state_;
   LitConstState lit_const_state_;
   NumberState number_state_;
-  IState* current_state_;
+  StateId state_;
+  Engine engine_;
+  TableLexer table_lexer_;
+  LexerStats stats_;
+  const HardwareCounters* profiler_;
 };
 
 #endif
\ No newline at end of file
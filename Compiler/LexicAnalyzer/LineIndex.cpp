@@ -0,0 +1,33 @@
+#include "LineIndex.h"
+
+#include <algorithm>
+
+#include "Scanner.h"
+
+LineIndex::LineIndex(const char* begin, const char* end, size_t first_line) :
+      begin_(begin),
+      end_(end),
+      first_line_(first_line),
+      scanned_(begin),
+      line_starts_(1, 0) {}
+
+LineIndex::Location LineIndex::GetLocation(size_t offset) {
+  const char* position = begin_ + offset;
+  while (scanned_ < position) {
+    const char* newline = Scanner::FindNewline(scanned_, end_);
+    if (newline >= position) {
+      scanned_ = position;
+      break;
+    }
+    scanned_ = newline + 1;
+    line_starts_.push_back(static_cast<uint32_t>(scanned_ - begin_));
+  }
+  auto line = std::upper_bound(line_starts_.begin(), line_starts_.end(),
+                               static_cast<uint32_t>(offset)) - 1;
+  size_t column = 0;
+  for (const char* cursor = begin_ + *line; cursor != position; ++cursor) {
+    // UTF-8 continuation bytes do not start a character.
+    if ((static_cast<uint8_t>(*cursor) & 0xC0) != 0x80) ++column;
+  }
+  return Location{first_line_ + (line - line_starts_.begin()), column};
+}
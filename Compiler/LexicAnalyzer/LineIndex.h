@@ -0,0 +1,35 @@
+#ifndef LINEINDEX
+#define LINEINDEX
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Converts byte offsets into a source to line and column. Tokens only
+// carry their offset; the offsets of line starts are collected with the
+// SIMD newline scanner the first time a location is asked for, and only as
+// far into the source as that location.
+class LineIndex {
+ public:
+  struct Location {
+    // Numbered from the first_line given to the index.
+    size_t line;
+    // Characters, not bytes, before the location on its line.
+    size_t column;
+  };
+
+  LineIndex(const char* begin, const char* end, size_t first_line = 1);
+
+  // offset may be the size of the source, i.e. its end.
+  Location GetLocation(size_t offset);
+
+ private:
+  const char* begin_;
+  const char* end_;
+  size_t first_line_;
+  // Everything before scanned_ is indexed.
+  const char* scanned_;
+  std::vector<uint32_t> line_starts_;
+};
+
+#endif
@@ -7,50 +7,55 @@ LitConstState::LitConstState(LexicAnalyzer* fsm) :
       read_first_char_(false) {}
 
 void LitConstState::Execute() {
-  if (state_machine_->Peek() == '\n' || !state_machine_->HasNext()) {
-    state_machine_->ThrowException(
-          "error: unexpected end of literal constant");
-  }
-  if (state_machine_->Peek() == '\\') {
-    if (is_char_ && read_first_char_) {
-      state_machine_->ThrowException(
-          "exception thrown: data-type char "
-          "can only contain single character");
+  // Up to and including the closing quote.
+  for (;;) {
+    if (!is_char_) state_machine_->AddStringTextToBuffer();
+    char32_t symbol = state_machine_->Peek();
+    if (symbol == '\n' || symbol == LexicAnalyzer::kEndOfSource) {
+      state_machine_->ReportError(Diagnostic::Code::UNTERMINATED_LITERAL,
+                                  Diagnostic::kUnterminatedLiteral);
+      return;
     }
-    state_machine_->SkipChar();
-    read_first_char_ = true;
-    state_machine_->AddCharToBuffer(
-        state_machine_->ToControl(state_machine_->Peek()));
-    state_machine_->SkipChar();
-    return;
-  }
-
-  if (is_char_) {
-    if (state_machine_->Peek() != '\'') {
-      if (read_first_char_) {
-        state_machine_->ThrowException(
-            "exception thrown: data-type char "
-            "can only contain single character");
+    if (symbol == '\\') {
+      if (is_char_ && read_first_char_) {
+        state_machine_->ReportError(Diagnostic::Code::INVALID_CHAR_LITERAL,
+                                    Diagnostic::kCharLiteralError);
+        return;
       }
-      state_machine_->AddNextCharToBuffer();
+      state_machine_->SkipChar();
       read_first_char_ = true;
-      return;
-    }
-    if (read_first_char_) {
-      state_machine_->SkipChar(); 
-      state_machine_->AddBufferToQueue(Token::Type::LITCONSTANT);
-      state_machine_->ChangeState(state_machine_->GetBeginState());
-      ResetState();
-      return;
+      symbol = state_machine_->Peek();
+      // A backslash at the end of the line leaves the literal unterminated.
+      if (symbol == '\n' || symbol == LexicAnalyzer::kEndOfSource) continue;
+      char32_t control = state_machine_->ToControl(symbol);
+      if (control == LexerVocabulary::kInvalidEscape) {
+        state_machine_->ReportError(Diagnostic::Code::INVALID_ESCAPE,
+                                    Diagnostic::kUnknownEscape);
+        return;
+      }
+      state_machine_->AddCharToBuffer(control);
+      state_machine_->SkipChar();
+      continue;
     }
-    state_machine_->ThrowException(
-        "exception thrown: data-type char "
-        "can only contain single character");
-  } else {
-    if (state_machine_->Peek() != '\"') {
-      state_machine_->AddNextCharToBuffer();
+
+    if (is_char_) {
+      if (symbol != '\'') {
+        if (read_first_char_) {
+          state_machine_->ReportError(Diagnostic::Code::INVALID_CHAR_LITERAL,
+                                      Diagnostic::kCharLiteralError);
+          return;
+        }
+        state_machine_->AddNextCharToBuffer();
+        read_first_char_ = true;
+        continue;
+      }
+      if (read_first_char_) break;
+      state_machine_->ReportError(Diagnostic::Code::INVALID_CHAR_LITERAL,
+                                  Diagnostic::kCharLiteralError);
       return;
     }
+    if (symbol == '\"') break;
+    state_machine_->AddNextCharToBuffer();
   }
   state_machine_->SkipChar();
   state_machine_->AddBufferToQueue(Token::Type::LITCONSTANT);
@@ -12,10 +12,10 @@ class LitConstState : public IState {
   virtual void Execute() final override;
   
   void SetState(bool state);
+  void ResetState();
 
  private:
   LexicAnalyzer* state_machine_;
-  void ResetState();
   bool is_char_;
   bool read_first_char_;
 };
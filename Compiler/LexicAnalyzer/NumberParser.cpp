@@ -0,0 +1,46 @@
+#include "NumberParser.h"
+
+#include <charconv>
+#include <cstdint>
+#include <system_error>
+
+bool NumberParser::Parse(std::string_view text, Format format,
+                         Token& token) {
+  const char* begin = text.data();
+  const char* end = begin + text.size();
+  if (format == Format::REAL) {
+    double real = 0.0;
+    std::from_chars_result result = std::from_chars(begin, end, real);
+    if (result.ec == std::errc::result_out_of_range) {
+      // Out of range either way; only a negative exponent means underflow.
+      if (text.find("e-") == std::string_view::npos &&
+          text.find("E-") == std::string_view::npos) {
+        return false;
+      }
+      real = 0.0;
+    }
+    token.value_type = Token::ValueType::REAL;
+    token.value.real = real;
+    return true;
+  }
+  int base = 10;
+  if (format == Format::HEX) {
+    // Skip "0x".
+    begin += 2;
+    base = 16;
+  }
+  uint64_t integer = 0;
+  std::from_chars_result result = std::from_chars(begin, end, integer, base);
+  if (result.ec == std::errc::result_out_of_range) return false;
+  token.value_type = Token::ValueType::INTEGER;
+  token.value.integer = integer;
+  return true;
+}
+
+std::string_view NumberParser::TrimLeadingZeros(std::string_view digits) {
+  size_t first = digits.find_first_not_of('0');
+  if (first == std::string_view::npos) {
+    return digits.empty() ? digits : digits.substr(digits.size() - 1);
+  }
+  return digits.substr(first);
+}
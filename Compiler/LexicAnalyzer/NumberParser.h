@@ -0,0 +1,28 @@
+#ifndef NUMBERPARSER
+#define NUMBERPARSER
+
+#include <string_view>
+
+#include "Token.h"
+
+// Computes the value of a numeric literal once NumberState or TableLexer
+// has matched it, straight from the matched span: std::from_chars does the
+// conversion, correctly rounded for reals, without allocating or touching
+// the locale.
+class NumberParser {
+ public:
+  enum class Format {
+    DECIMAL,
+    HEX,
+    REAL
+  };
+
+  // Sets token.value_type and token.value. Returns false when the value
+  // does not fit a uint64_t or, for reals, overflows a double; reals too
+  // small for a double become 0.
+  static bool Parse(std::string_view text, Format format, Token& token);
+  // "007" -> "7", "000" -> "0".
+  static std::string_view TrimLeadingZeros(std::string_view digits);
+};
+
+#endif
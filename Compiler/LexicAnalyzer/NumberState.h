@@ -13,6 +13,7 @@ class NumberState : public IState {
   NumberState(LexicAnalyzer* fsm);
  
   virtual void Execute() final override;
+  void ResetState();
 
  private:
   enum class State {
@@ -1,14 +1,17 @@
 #include "OperatorState.h"
 #include "LexicAnalyzer.h"
+#include "Utf8.h"
 
 OperatorState::OperatorState(LexicAnalyzer* fsm) : state_machine_(fsm) {}
 
 void OperatorState::Execute() {
-  if (state_machine_->IsOperator(state_machine_->GetBuffer() + 
-                                 state_machine_->Peek())) {
+  // The longest operator that the buffer starts.
+  std::string candidate(state_machine_->GetBuffer());
+  for (;;) {
+    AppendUtf8(candidate, state_machine_->Peek());
+    if (!state_machine_->IsOperator(candidate)) break;
     state_machine_->AddNextCharToBuffer();
-    return;
-  } 
+  }
   state_machine_->AddBufferToQueue(Token::Type::OPERATOR);
   state_machine_->ChangeState(state_machine_->GetBeginState());
 }
\ No newline at end of file
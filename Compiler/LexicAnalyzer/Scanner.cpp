@@ -0,0 +1,252 @@
+#include "Scanner.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SCANNER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SCANNER_X86) && defined(__GNUC__)
+#define SCANNER_AVX2 __attribute__((target("avx2")))
+#else
+#define SCANNER_AVX2
+#endif
+
+namespace {
+
+#pragma region BYTE_CLASSES
+// Every class provides a scalar Match and, on x86, vector Matches that
+// return 0xFF in each byte lane belonging to the run.
+struct Blank {
+  static bool Match(uint8_t byte) {
+    return byte == ' ' || byte == '\t' || byte == '\n' || byte == '\r';
+  }
+#ifdef SCANNER_X86
+  static __m128i Match(__m128i bytes) {
+    return _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')),
+                     _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t'))),
+        _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')),
+                     _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r'))));
+  }
+  SCANNER_AVX2 static __m256i Match(__m256i bytes) {
+    return _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')),
+                        _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')),
+                        _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\r'))));
+  }
+#endif
+};
+
+// Range checks use signed compares, bytes >= 0x80 are negative and never
+// fall into an ASCII range.
+struct Digit {
+  static bool Match(uint8_t byte) { return byte >= '0' && byte <= '9'; }
+#ifdef SCANNER_X86
+  static __m128i Match(__m128i bytes) {
+    return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('0' - 1)),
+                         _mm_cmplt_epi8(bytes, _mm_set1_epi8('9' + 1)));
+  }
+  SCANNER_AVX2 static __m256i Match(__m256i bytes) {
+    return _mm256_and_si256(
+        _mm256_cmpgt_epi8(bytes, _mm256_set1_epi8('0' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), bytes));
+  }
+#endif
+};
+
+struct Identifier {
+  static bool Match(uint8_t byte) {
+    uint8_t lower = byte | 0x20;
+    return (lower >= 'a' && lower <= 'z') || Digit::Match(byte) ||
+           byte == '_';
+  }
+#ifdef SCANNER_X86
+  static __m128i Match(__m128i bytes) {
+    __m128i lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+    __m128i letter =
+        _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                      _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+    return _mm_or_si128(
+        _mm_or_si128(letter, Digit::Match(bytes)),
+        _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_')));
+  }
+  SCANNER_AVX2 static __m256i Match(__m256i bytes) {
+    __m256i lower = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+    __m256i letter = _mm256_and_si256(
+        _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+    return _mm256_or_si256(
+        _mm256_or_si256(letter, Digit::Match(bytes)),
+        _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('_')));
+  }
+#endif
+};
+
+struct NotNewline {
+  static bool Match(uint8_t byte) { return byte != '\n'; }
+#ifdef SCANNER_X86
+  static __m128i Match(__m128i bytes) {
+    return _mm_xor_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')),
+                         _mm_set1_epi8(-1));
+  }
+  SCANNER_AVX2 static __m256i Match(__m256i bytes) {
+    return _mm256_xor_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')),
+                            _mm256_set1_epi8(-1));
+  }
+#endif
+};
+
+struct StringText {
+  static bool Match(uint8_t byte) {
+    return byte != '"' && byte != '\\' && byte != '\n';
+  }
+#ifdef SCANNER_X86
+  static __m128i Match(__m128i bytes) {
+    __m128i stops = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('"')),
+                     _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\'))),
+        _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+    return _mm_xor_si128(stops, _mm_set1_epi8(-1));
+  }
+  SCANNER_AVX2 static __m256i Match(__m256i bytes) {
+    __m256i stops = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('"')),
+                        _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\\'))),
+        _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')));
+    return _mm256_xor_si256(stops, _mm256_set1_epi8(-1));
+  }
+#endif
+};
+#pragma endregion BYTE_CLASSES
+
+#pragma region KERNELS
+template <typename Class>
+const char* SkipScalar(const char* cursor, const char* end) {
+  while (cursor != end && Class::Match(static_cast<uint8_t>(*cursor))) {
+    ++cursor;
+  }
+  return cursor;
+}
+
+#ifdef SCANNER_X86
+unsigned CountTrailingZeros(uint32_t mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+template <typename Class>
+const char* SkipSse2(const char* cursor, const char* end) {
+  while (end - cursor >= 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor));
+    uint32_t misses =
+        ~static_cast<uint32_t>(_mm_movemask_epi8(Class::Match(bytes))) &
+        0xFFFF;
+    if (misses != 0) return cursor + CountTrailingZeros(misses);
+    cursor += 16;
+  }
+  return SkipScalar<Class>(cursor, end);
+}
+
+template <typename Class>
+SCANNER_AVX2 const char* SkipAvx2(const char* cursor, const char* end) {
+  while (end - cursor >= 32) {
+    __m256i bytes =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cursor));
+    uint32_t misses =
+        ~static_cast<uint32_t>(_mm256_movemask_epi8(Class::Match(bytes)));
+    if (misses != 0) return cursor + CountTrailingZeros(misses);
+    cursor += 32;
+  }
+  return SkipSse2<Class>(cursor, end);
+}
+#endif
+#pragma endregion KERNELS
+
+using SkipFunction = const char* (*)(const char*, const char*);
+
+struct Kernels {
+  Scanner::Level level;
+  SkipFunction skip_blanks;
+  SkipFunction skip_identifier;
+  SkipFunction skip_digits;
+  SkipFunction find_newline;
+  SkipFunction skip_string_text;
+};
+
+Kernels KernelsFor(Scanner::Level level) {
+  switch (level) {
+#ifdef SCANNER_X86
+    case Scanner::Level::AVX2:
+      return {level, SkipAvx2<Blank>, SkipAvx2<Identifier>, SkipAvx2<Digit>,
+              SkipAvx2<NotNewline>, SkipAvx2<StringText>};
+    case Scanner::Level::SSE2:
+      return {level, SkipSse2<Blank>, SkipSse2<Identifier>, SkipSse2<Digit>,
+              SkipSse2<NotNewline>, SkipSse2<StringText>};
+#endif
+    default:
+      return {Scanner::Level::SCALAR, SkipScalar<Blank>,
+              SkipScalar<Identifier>, SkipScalar<Digit>,
+              SkipScalar<NotNewline>, SkipScalar<StringText>};
+  }
+}
+
+Kernels kernels = KernelsFor(Scanner::DetectLevel());
+
+}  // namespace
+
+Scanner::Level Scanner::DetectLevel() {
+#ifdef SCANNER_X86
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+  __cpuidex(info, 7, 0);
+  if (os_saves_ymm && (info[1] & (1 << 5))) return Level::AVX2;
+#else
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return Level::AVX2;
+#endif
+  // SSE2 is part of x86-64.
+  return Level::SSE2;
+#else
+  return Level::SCALAR;
+#endif
+}
+
+Scanner::Level Scanner::GetLevel() { return kernels.level; }
+
+void Scanner::SetLevel(Level level) {
+  Level detected = DetectLevel();
+  kernels = KernelsFor(level > detected ? detected : level);
+}
+
+const char* Scanner::SkipBlanks(const char* cursor, const char* end) {
+  return kernels.skip_blanks(cursor, end);
+}
+
+const char* Scanner::SkipIdentifier(const char* cursor, const char* end) {
+  return kernels.skip_identifier(cursor, end);
+}
+
+const char* Scanner::SkipDigits(const char* cursor, const char* end) {
+  return kernels.skip_digits(cursor, end);
+}
+
+const char* Scanner::FindNewline(const char* cursor, const char* end) {
+  return kernels.find_newline(cursor, end);
+}
+
+const char* Scanner::SkipStringText(const char* cursor, const char* end) {
+  return kernels.skip_string_text(cursor, end);
+}
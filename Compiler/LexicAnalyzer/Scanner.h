@@ -0,0 +1,40 @@
+#ifndef SCANNER
+#define SCANNER
+
+// Bulk byte scanners for the lexer's hot loops. Each call returns the first
+// byte in [cursor, end) that does not belong to the run, so a whole run of
+// blanks, an identifier or a comment is consumed in one call, 16 (SSE2) or
+// 32 (AVX2) bytes at a time. The widest level the CPU supports is picked
+// once at startup; everything else falls back to plain loops.
+//
+// Only ASCII bytes are part of a run, callers handle the rest, except in
+// string text: it is copied as it is and UTF-8 never encodes an ASCII
+// character inside another.
+class Scanner {
+ public:
+  enum class Level {
+    SCALAR,
+    SSE2,
+    AVX2
+  };
+
+  static Level DetectLevel();
+  static Level GetLevel();
+  // Levels above DetectLevel() are clamped. Not thread-safe, meant for
+  // tests and benchmarks that compare the implementations.
+  static void SetLevel(Level level);
+
+  // ' ', '\t', '\n' and '\r', which ends lines in Windows files.
+  static const char* SkipBlanks(const char* cursor, const char* end);
+  // [A-Za-z0-9_].
+  static const char* SkipIdentifier(const char* cursor, const char* end);
+  // [0-9].
+  static const char* SkipDigits(const char* cursor, const char* end);
+  // Returns end when there is no '\n' left.
+  static const char* FindNewline(const char* cursor, const char* end);
+  // Anything but '"', '\\' and '\n', i.e. string literal text up to the
+  // next closing quote, escape or end of line.
+  static const char* SkipStringText(const char* cursor, const char* end);
+};
+
+#endif
@@ -0,0 +1,172 @@
+#include "SourceBuffer.h"
+
+#include <fstream>
+#include <iterator>
+
+#include "Utf8.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SourceBuffer::SourceBuffer() :
+      data_(nullptr),
+      size_(0),
+      is_open_(false),
+      is_mapped_(false) {}
+
+SourceBuffer::SourceBuffer(const std::string& file_name) : SourceBuffer() {
+  if (Map(file_name)) return;
+  std::ifstream file_input(file_name, std::ios::binary);
+  if (!file_input.is_open()) return;
+  owned_.assign(std::istreambuf_iterator<char>(file_input),
+                std::istreambuf_iterator<char>());
+  data_ = owned_.data();
+  size_ = owned_.size();
+  is_open_ = true;
+}
+
+SourceBuffer::SourceBuffer(std::wistream& input_stream) : SourceBuffer() {
+  std::wstring wide{std::istreambuf_iterator<wchar_t>(input_stream),
+                    std::istreambuf_iterator<wchar_t>()};
+  std::string bytes;
+  bytes.reserve(wide.size());
+  for (size_t i = 0; i < wide.size(); ++i) {
+    char32_t code_point = static_cast<char32_t>(wide[i]);
+    // 16-bit wchar_t hands out surrogate pairs which must be joined first.
+    if (code_point >= 0xD800 && code_point < 0xDC00 && i + 1 < wide.size()) {
+      char32_t low = static_cast<char32_t>(wide[i + 1]);
+      if (low >= 0xDC00 && low < 0xE000) {
+        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+        ++i;
+      }
+    }
+    AppendUtf8(bytes, code_point);
+  }
+  owned_.assign(bytes.begin(), bytes.end());
+  data_ = owned_.data();
+  size_ = owned_.size();
+  is_open_ = true;
+}
+
+SourceBuffer::SourceBuffer(const char* data, size_t size) :
+      SourceBuffer() {
+  owned_.assign(data, data + size);
+  data_ = owned_.data();
+  size_ = owned_.size();
+  is_open_ = true;
+}
+
+SourceBuffer SourceBuffer::View(const char* data, size_t size) {
+  SourceBuffer view;
+  view.data_ = data;
+  view.size_ = size;
+  view.is_open_ = true;
+  return view;
+}
+
+SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept :
+      data_(other.data_),
+      size_(other.size_),
+      is_open_(other.is_open_),
+      is_mapped_(other.is_mapped_),
+      owned_(std::move(other.owned_)) {
+  // Moving a vector keeps its storage, so data_ stays valid for owned,
+  // mapped and borrowed buffers alike.
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.is_open_ = false;
+  other.is_mapped_ = false;
+}
+
+SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+  if (this == &other) return *this;
+  Unmap();
+  data_ = other.data_;
+  size_ = other.size_;
+  is_open_ = other.is_open_;
+  is_mapped_ = other.is_mapped_;
+  owned_ = std::move(other.owned_);
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.is_open_ = false;
+  other.is_mapped_ = false;
+  return *this;
+}
+
+SourceBuffer::~SourceBuffer() { Unmap(); }
+
+bool SourceBuffer::IsOpen() const { return is_open_; }
+
+const char* SourceBuffer::Begin() const { return data_; }
+
+const char* SourceBuffer::End() const { return data_ + size_; }
+
+size_t SourceBuffer::Size() const { return size_; }
+
+#ifdef _WIN32
+
+bool SourceBuffer::Map(const std::string& file_name) {
+  HANDLE file = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0,
+                                      nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr) return false;
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (view == nullptr) return false;
+  data_ = static_cast<const char*>(view);
+  size_ = static_cast<size_t>(file_size.QuadPart);
+  is_open_ = true;
+  is_mapped_ = true;
+  return true;
+}
+
+void SourceBuffer::Unmap() {
+  if (is_mapped_) UnmapViewOfFile(data_);
+  is_mapped_ = false;
+}
+
+#else
+
+bool SourceBuffer::Map(const std::string& file_name) {
+  int file = open(file_name.c_str(), O_RDONLY);
+  if (file < 0) return false;
+  struct stat file_stat;
+  if (fstat(file, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) ||
+      file_stat.st_size == 0) {
+    close(file);
+    return false;
+  }
+  void* view = mmap(nullptr, static_cast<size_t>(file_stat.st_size),
+                    PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  if (view == MAP_FAILED) return false;
+  madvise(view, static_cast<size_t>(file_stat.st_size), MADV_SEQUENTIAL);
+  data_ = static_cast<const char*>(view);
+  size_ = static_cast<size_t>(file_stat.st_size);
+  is_open_ = true;
+  is_mapped_ = true;
+  return true;
+}
+
+void SourceBuffer::Unmap() {
+  if (is_mapped_) munmap(const_cast<char*>(data_), size_);
+  is_mapped_ = false;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef SOURCEBUFFER
+#define SOURCEBUFFER
+
+#include <istream>
+#include <string>
+#include <vector>
+
+// Read-only UTF-8 view of a whole source file. Files are memory-mapped when
+// the platform allows it and read in one go otherwise; wide streams are
+// drained and re-encoded, which keeps the old std::wifstream entry point.
+class SourceBuffer {
+ public:
+  SourceBuffer();
+  explicit SourceBuffer(const std::string& file_name);
+  explicit SourceBuffer(std::wistream& input_stream);
+  SourceBuffer(const char* data, size_t size);
+  // Borrows [data, data + size) without copying, the memory must outlive
+  // the view and everything lexed from it.
+  static SourceBuffer View(const char* data, size_t size);
+
+  SourceBuffer(SourceBuffer&& other) noexcept;
+  SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+  SourceBuffer(const SourceBuffer&) = delete;
+  SourceBuffer& operator=(const SourceBuffer&) = delete;
+  ~SourceBuffer();
+
+  bool IsOpen() const;
+  const char* Begin() const;
+  const char* End() const;
+  size_t Size() const;
+
+ private:
+  bool Map(const std::string& file_name);
+  void Unmap();
+
+  const char* data_;
+  size_t size_;
+  bool is_open_;
+  bool is_mapped_;
+  std::vector<char> owned_;
+};
+
+#endif
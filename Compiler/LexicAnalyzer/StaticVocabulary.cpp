@@ -0,0 +1,32 @@
+#include "StaticVocabulary.h"
+
+#include <algorithm>
+
+namespace {
+
+// Empty entries come from the trailing newline of the list files and never
+// reach a lookup, so they are ignored on both sides of the comparison.
+template <typename Words>
+bool SameWords(const std::set<std::string, std::less<>>& loaded,
+               const Words& compiled_in) {
+  size_t non_empty = loaded.size() - loaded.count("");
+  if (non_empty != std::size(compiled_in)) return false;
+  return std::all_of(std::begin(compiled_in), std::end(compiled_in),
+                     [&loaded](auto word) {
+                       return loaded.find(word) != loaded.end();
+                     });
+}
+
+}  // namespace
+
+bool StaticVocabulary::Matches(
+    const std::set<std::string, std::less<>>& reserved,
+    const std::set<std::string, std::less<>>& operators,
+    const std::set<std::string, std::less<>>& punctuation) {
+  std::string_view punctuation_words[std::size(kPunctuation)];
+  for (size_t i = 0; i < std::size(kPunctuation); ++i) {
+    punctuation_words[i] = std::string_view(&kPunctuation[i], 1);
+  }
+  return SameWords(reserved, kReserved) && SameWords(operators, kOperators) &&
+         SameWords(punctuation, punctuation_words);
+}
@@ -0,0 +1,153 @@
+#ifndef STATICVOCABULARY
+#define STATICVOCABULARY
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <set>
+#include <string>
+#include <string_view>
+
+// Compiled-in copy of lists/reserved_ids.txt, lists/operators.txt,
+// lists/punctuations.txt and lists/backslashes.txt. Words are packed into
+// a 64-bit integer and looked up in a 256-slot table whose multiplicative
+// hash seed is searched for at compile time so that no two words collide:
+// one multiply, one shift and one compare per lookup, without allocation.
+// LexicAnalyzer only uses it when the loaded lists are exactly these,
+// custom dialects keep the sets.
+class StaticVocabulary {
+ public:
+  static constexpr std::string_view kReserved[] = {
+      "if", "else", "elif", "switch", "for", "while", "do", "return",
+      "break", "goto", "continue", "try", "throw", "catch", "case",
+      "default", "new", "delete", "import", "int8", "int16", "int32",
+      "int64", "unsigned", "double", "float", "char", "let", "const", "var",
+      "void", "and", "or", "not", "func", "NIL", "NULL"};
+
+  static constexpr std::string_view kOperators[] = {
+      "!", "$", "%", "^", "&", "*", "-", "+", "=", "<", "<<", "<<=", ">",
+      ">>", ">>=", "/", "~", "|", "@", "++", "+=", "->", "->=", "--", "-=",
+      "==", "<=", ">=", "**", "*=", "**=", "//", "/=", "//=", "^=", "&=",
+      "&&", "|=", "||", "%=", "and", "or", "not"};
+
+  static constexpr char kPunctuation[] = {',', ';', ':', '{', '}',
+                                          '(', ')', '[', ']'};
+
+  // Escaped character and the character it stands for.
+  static constexpr char kBackslashes[][2] = {
+      {'0', '\0'}, {'b', '\b'}, {'t', '\t'}, {'n', '\n'}, {'v', '\v'},
+      {'r', '\r'}, {'e', '\033'}, {'"', '"'}, {'\'', '\''}, {'\\', '\\'}};
+
+  static bool IsReserved(std::string_view text) {
+    return Contains(kReservedTable, text);
+  }
+
+  static bool IsOperator(std::string_view text) {
+    return Contains(kOperatorTable, text);
+  }
+
+  static bool IsPunctuation(char32_t symbol) {
+    return symbol < 128 && kPunctuationTable[symbol];
+  }
+
+  static bool Matches(const std::set<std::string, std::less<>>& reserved,
+                      const std::set<std::string, std::less<>>& operators,
+                      const std::set<std::string, std::less<>>& punctuation);
+
+ private:
+  static constexpr size_t kMaxLength = 8;
+  static constexpr uint8_t kEmptySlot = 0xFF;
+
+  template <size_t N>
+  struct PerfectHashTable {
+    uint64_t seed;
+    std::array<uint8_t, 256> slots;
+    std::array<uint64_t, N> keys;
+    std::array<uint8_t, N> lengths;
+  };
+
+  static constexpr uint64_t Pack(std::string_view text) {
+    uint64_t key = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+      key |= static_cast<uint64_t>(static_cast<uint8_t>(text[i])) << (8 * i);
+    }
+    return key;
+  }
+
+  // splitmix64 finalizer: consecutive attempts get unrelated seeds.
+  static constexpr uint64_t Mix(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+  }
+
+  static constexpr size_t Slot(uint64_t key, uint64_t seed) {
+    return static_cast<size_t>((key * seed) >> 56);
+  }
+
+  template <size_t N>
+  static constexpr PerfectHashTable<N> Build(
+      const std::string_view (&words)[N]) {
+    static_assert(N < kEmptySlot, "too many words for a 256-slot table");
+    PerfectHashTable<N> table{};
+    for (size_t i = 0; i < N; ++i) {
+      table.keys[i] = Pack(words[i]);
+      table.lengths[i] = static_cast<uint8_t>(words[i].size());
+    }
+    for (uint64_t attempt = 0;; ++attempt) {
+      uint64_t seed = Mix(attempt) | 1;
+      for (size_t slot = 0; slot < table.slots.size(); ++slot) {
+        table.slots[slot] = kEmptySlot;
+      }
+      bool is_perfect = true;
+      for (size_t i = 0; i < N && is_perfect; ++i) {
+        uint8_t& slot = table.slots[Slot(table.keys[i], seed)];
+        is_perfect = slot == kEmptySlot;
+        slot = static_cast<uint8_t>(i);
+      }
+      if (is_perfect) {
+        table.seed = seed;
+        return table;
+      }
+    }
+  }
+
+  template <size_t N>
+  static bool Contains(const PerfectHashTable<N>& table,
+                       std::string_view text) {
+    if (text.empty() || text.size() > kMaxLength) return false;
+    uint64_t key = Pack(text);
+    uint8_t index = table.slots[Slot(key, table.seed)];
+    return index != kEmptySlot && table.keys[index] == key &&
+           table.lengths[index] == text.size();
+  }
+
+  static constexpr std::array<bool, 128> BuildPunctuation() {
+    std::array<bool, 128> table{};
+    for (char symbol : kPunctuation) {
+      table[static_cast<uint8_t>(symbol)] = true;
+    }
+    return table;
+  }
+
+  static const PerfectHashTable<std::size(kReserved)> kReservedTable;
+  static const PerfectHashTable<std::size(kOperators)> kOperatorTable;
+  static const std::array<bool, 128> kPunctuationTable;
+};
+
+// Defined out of class: the builders can only be evaluated once the class
+// is complete.
+inline constexpr StaticVocabulary::PerfectHashTable<
+    std::size(StaticVocabulary::kReserved)>
+    StaticVocabulary::kReservedTable = StaticVocabulary::Build(kReserved);
+
+inline constexpr StaticVocabulary::PerfectHashTable<
+    std::size(StaticVocabulary::kOperators)>
+    StaticVocabulary::kOperatorTable = StaticVocabulary::Build(kOperators);
+
+inline constexpr std::array<bool, 128> StaticVocabulary::kPunctuationTable =
+    StaticVocabulary::BuildPunctuation();
+
+#endif
@@ -0,0 +1,103 @@
+#include "StringInterner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+StringInterner::Cache::Cache(StringInterner* interner) :
+      interner_(interner) {}
+
+uint32_t StringInterner::Cache::Intern(std::string_view text) {
+  uint64_t hash = Hash(text);
+  const Table::Slot* found = table_.Find(hash, text);
+  if (found != nullptr) return found->id;
+  Table::Slot slot = interner_->Intern(hash, text);
+  table_.Insert(slot);
+  return slot.id;
+}
+
+uint32_t StringInterner::Intern(std::string_view text) {
+  return Intern(Hash(text), text).id;
+}
+
+StringInterner::Table::Slot StringInterner::Intern(uint64_t hash,
+                                                   std::string_view text) {
+  Shard& shard = shards_[hash >> (64 - kShardBits)];
+  {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    const Table::Slot* found = shard.table.Find(hash, text);
+    if (found != nullptr) return *found;
+  }
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  // Another thread may have added it between the two locks.
+  const Table::Slot* found = shard.table.Find(hash, text);
+  if (found != nullptr) return *found;
+  if (text.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("exception thrown: identifier is too long");
+  }
+  Table::Slot slot{hash, shard.texts.Copy(text).data(),
+                   static_cast<uint32_t>(text.size()), 0};
+  {
+    std::unique_lock<std::shared_mutex> texts_lock(texts_mutex_);
+    if (texts_by_id_.size() == std::numeric_limits<uint32_t>::max()) {
+      throw std::runtime_error("exception thrown: too many identifiers");
+    }
+    slot.id = static_cast<uint32_t>(texts_by_id_.size());
+    texts_by_id_.emplace_back(slot.text, slot.length);
+  }
+  shard.table.Insert(slot);
+  return slot;
+}
+
+std::string_view StringInterner::GetText(uint32_t id) const {
+  std::shared_lock<std::shared_mutex> lock(texts_mutex_);
+  return texts_by_id_[id];
+}
+
+size_t StringInterner::Size() const {
+  std::shared_lock<std::shared_mutex> lock(texts_mutex_);
+  return texts_by_id_.size();
+}
+
+uint64_t StringInterner::Hash(std::string_view text) {
+  // FNV-1a, finished with a multiply so that the top bits, which pick the
+  // shard, depend on every byte.
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (char byte : text) {
+    hash = (hash ^ static_cast<uint8_t>(byte)) * 0x100000001B3ull;
+  }
+  return (hash ^ (hash >> 29)) * 0xBF58476D1CE4E5B9ull;
+}
+
+const StringInterner::Table::Slot* StringInterner::Table::Find(
+    uint64_t hash, std::string_view text) const {
+  if (slots_.empty()) return nullptr;
+  size_t mask = slots_.size() - 1;
+  for (size_t index = hash & mask;; index = (index + 1) & mask) {
+    const Slot& slot = slots_[index];
+    if (slot.text == nullptr) return nullptr;
+    if (slot.hash == hash && slot.length == text.size() &&
+        std::memcmp(slot.text, text.data(), text.size()) == 0) {
+      return &slot;
+    }
+  }
+}
+
+void StringInterner::Table::Insert(const Slot& slot) {
+  // Grow at a load factor of 1/2.
+  if ((count_ + 1) * 2 > slots_.size()) {
+    std::vector<Slot> old_slots(std::max<size_t>(slots_.size() * 2, 64));
+    old_slots.swap(slots_);
+    count_ = 0;
+    for (const Slot& old_slot : old_slots) {
+      if (old_slot.text != nullptr) Insert(old_slot);
+    }
+  }
+  size_t mask = slots_.size() - 1;
+  size_t index = slot.hash & mask;
+  while (slots_[index].text != nullptr) index = (index + 1) & mask;
+  slots_[index] = slot;
+  ++count_;
+}
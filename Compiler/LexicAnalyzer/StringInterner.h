@@ -0,0 +1,85 @@
+#ifndef STRINGINTERNER
+#define STRINGINTERNER
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+#include "Arena.h"
+
+// Maps identifier text to dense 32-bit ids, 0, 1, 2, ... in order of first
+// appearance, so later stages compare identifiers as integers. Safe to
+// share between the analyzers of a batch or of a ParallelLexer: the table
+// is split into shards by hash, each behind its own reader-writer lock.
+// With more than one thread interning, which text gets which id depends on
+// scheduling.
+class StringInterner {
+  // Open addressing with linear probing; growing is the only allocation.
+  class Table {
+   public:
+    struct Slot {
+      uint64_t hash;
+      // Points into the interner's storage; nullptr marks an empty slot.
+      const char* text;
+      uint32_t length;
+      uint32_t id;
+    };
+
+    const Slot* Find(uint64_t hash, std::string_view text) const;
+    void Insert(const Slot& slot);
+
+   private:
+    std::vector<Slot> slots_;
+    size_t count_ = 0;
+  };
+
+ public:
+  StringInterner() = default;
+  StringInterner(const StringInterner&) = delete;
+  StringInterner& operator=(const StringInterner&) = delete;
+
+  // Unsynchronized front for a single thread, each analyzer has one. It
+  // remembers every text it has interned, so only the first occurrence of
+  // an identifier in a source takes a lock.
+  class Cache {
+   public:
+    explicit Cache(StringInterner* interner);
+
+    uint32_t Intern(std::string_view text);
+
+   private:
+    StringInterner* interner_;
+    Table table_;
+  };
+
+  uint32_t Intern(std::string_view text);
+  // id must have been returned by Intern(). The view stays valid for the
+  // interner's lifetime.
+  std::string_view GetText(uint32_t id) const;
+  size_t Size() const;
+
+ private:
+  static constexpr size_t kShardBits = 4;
+  static constexpr size_t kShardCount = size_t(1) << kShardBits;
+
+  struct Shard {
+    mutable std::shared_mutex mutex;
+    Table table;
+    // Texts never move once copied here.
+    Arena texts;
+  };
+
+  static uint64_t Hash(std::string_view text);
+  Table::Slot Intern(uint64_t hash, std::string_view text);
+
+  std::array<Shard, kShardCount> shards_;
+  // id -> text, appended to while holding a shard's lock.
+  mutable std::shared_mutex texts_mutex_;
+  std::deque<std::string_view> texts_by_id_;
+};
+
+#endif
@@ -0,0 +1,361 @@
+#include "TableLexer.h"
+#include "LexicAnalyzer.h"
+#include "LexerVocabulary.h"
+
+#include "Scanner.h"
+#include "UnicodeClasses.h"
+#include "Utf8.h"
+
+TableLexer::TableLexer(LexicAnalyzer* fsm, const Tables* tables) :
+      state_machine_(fsm),
+      tables_(tables) {}
+
+TableLexer::Tables::Tables(const LexerVocabulary& vocabulary) {
+  #pragma region OPERATOR_TRIE
+  std::array<int16_t, 256> no_edges;
+  no_edges.fill(-1);
+  operator_transitions.assign(1, no_edges);
+  operator_accepting.assign(1, false);
+  for (const std::string& oper : vocabulary.GetOperators()) {
+    int node = 0;
+    for (char byte : oper) {
+      int16_t edge = operator_transitions[node][static_cast<uint8_t>(byte)];
+      if (edge < 0) {
+        // push_back may reallocate, so the edge is stored by index.
+        edge = static_cast<int16_t>(operator_transitions.size());
+        operator_transitions[node][static_cast<uint8_t>(byte)] = edge;
+        operator_transitions.push_back(no_edges);
+        operator_accepting.push_back(false);
+      }
+      node = edge;
+    }
+    if (node != 0) operator_accepting[node] = true;
+  }
+  #pragma endregion OPERATOR_TRIE
+
+  #pragma region CHAR_CLASSES
+  // Same precedence as the chain of checks in BeginState::Execute().
+  for (int byte = 0; byte < 128; ++byte) {
+    char32_t symbol = static_cast<char32_t>(byte);
+    CharClass char_class = OTHER;
+    if (symbol == '\"') {
+      char_class = QUOTE;
+    } else if (symbol == '\'') {
+      char_class = APOSTROPHE;
+    } else if (symbol == '\n' || symbol == ' ' || symbol == '\t' ||
+               symbol == '\r') {
+      char_class = WHITESPACE;
+    } else if (symbol == '#') {
+      char_class = HASH;
+    } else if (UnicodeClasses::IsDigit(symbol)) {
+      char_class = DIGIT;
+    } else if (UnicodeClasses::IsIdentifierStart(symbol)) {
+      char_class = ID_START;
+    } else if (vocabulary.IsPunctuation(symbol)) {
+      char_class = PUNCTUATION;
+    } else if (operator_transitions[0][byte] >= 0 &&
+               operator_accepting[operator_transitions[0][byte]]) {
+      char_class = OPERATOR;
+    }
+    char_classes[byte] = char_class;
+
+    char32_t low_symbol = UnicodeClasses::ToLower(symbol);
+    NumberClass number_class = NUM_OTHER;
+    if (UnicodeClasses::IsDigit(low_symbol)) {
+      number_class = NUM_DIGIT;
+    } else if (low_symbol == 'e') {
+      number_class = NUM_E;
+    } else if (low_symbol >= 'a' && low_symbol <= 'f') {
+      number_class = NUM_HEX_LETTER;
+    } else if (low_symbol == 'x') {
+      number_class = NUM_X;
+    } else if (low_symbol == '.') {
+      number_class = NUM_DOT;
+    } else if (low_symbol == '+' || low_symbol == '-') {
+      number_class = NUM_SIGN;
+    }
+    number_classes[byte] = number_class;
+  }
+  #pragma endregion CHAR_CLASSES
+
+  #pragma region NUMBER_TRANSITIONS
+  // Mirrors the switch in NumberState::Execute().
+  for (auto& row : number_transitions) row.fill({EMIT, INTEGER});
+  auto& integer = number_transitions[INTEGER];
+  integer.fill({EMIT_NORMALIZED, INTEGER});
+  integer[NUM_DIGIT] = {CONSUME, INTEGER};
+  integer[NUM_DOT] = {CONSUME, FLOAT};
+  integer[NUM_E] = {CONSUME, EFOUND};
+  integer[NUM_X] = {HEX_PREFIX, HEX};
+
+  auto& hex = number_transitions[HEX];
+  hex[NUM_DIGIT] = hex[NUM_HEX_LETTER] = hex[NUM_E] = {CONSUME, HEX};
+
+  auto& efound = number_transitions[EFOUND];
+  efound.fill({ERROR_AFTER_E, EFOUND});
+  efound[NUM_DIGIT] = {CONSUME, EXP};
+  efound[NUM_SIGN] = {CONSUME, EWAITNUM};
+
+  auto& ewaitnum = number_transitions[EWAITNUM];
+  ewaitnum.fill({ERROR_AFTER_SIGN, EWAITNUM});
+  ewaitnum[NUM_DIGIT] = {CONSUME, ONLYINTEGER};
+
+  auto& real = number_transitions[FLOAT];
+  real[NUM_DIGIT] = {CONSUME, FLOAT};
+  real[NUM_E] = {CONSUME, EFOUND};
+
+  auto& exp = number_transitions[EXP];
+  exp[NUM_DIGIT] = {CONSUME, EXP};
+  exp[NUM_E] = {ERROR_SECOND_EXPONENT, EXP};
+  exp[NUM_DOT] = {ERROR_FLOAT_EXPONENT, EXP};
+
+  auto& only_integer = number_transitions[ONLYINTEGER];
+  only_integer[NUM_DIGIT] = {CONSUME, ONLYINTEGER};
+  only_integer[NUM_E] = only_integer[NUM_DOT] = {ERROR_FLOAT_EXPONENT,
+                                                 ONLYINTEGER};
+  #pragma endregion NUMBER_TRANSITIONS
+}
+
+TableLexer::CharClass TableLexer::Classify(const char* cursor) const {
+  uint8_t byte = static_cast<uint8_t>(*cursor);
+  if (byte < 0x80) return tables_->char_classes[byte];
+  const char* end = state_machine_->end_;
+  char32_t symbol = DecodeUtf8(cursor, end);
+  if (UnicodeClasses::IsDigit(symbol)) return DIGIT;
+  if (UnicodeClasses::IsIdentifierStart(symbol)) return ID_START;
+  if (state_machine_->IsPunctuation(symbol)) return PUNCTUATION;
+  if (StepOperator(0, cursor, Utf8SequenceLength(cursor, end)) >= 0) {
+    return OPERATOR;
+  }
+  return OTHER;
+}
+
+TableLexer::NumberClass TableLexer::ClassifyNumber(const char* cursor) const {
+  if (cursor == state_machine_->end_) return NUM_OTHER;
+  uint8_t byte = static_cast<uint8_t>(*cursor);
+  return byte < 0x80 ? tables_->number_classes[byte] : NUM_OTHER;
+}
+
+int TableLexer::StepOperator(int node, const char* cursor,
+                             size_t length) const {
+  for (size_t i = 0; i < length; ++i) {
+    node =
+        tables_->operator_transitions[node][static_cast<uint8_t>(cursor[i])];
+    if (node < 0) return -1;
+  }
+  return tables_->operator_accepting[node] ? node : -1;
+}
+
+void TableLexer::Execute() {
+  LexicAnalyzer& fsm = *state_machine_;
+  SkipBlanks();
+  if (!fsm.HasNext()) return;
+  fsm.token_start_ = fsm.cursor_;
+  switch (Classify(fsm.cursor_)) {
+    case QUOTE:
+      fsm.SkipChar();
+      ScanLiteral(false);
+      return;
+    case APOSTROPHE:
+      fsm.SkipChar();
+      ScanLiteral(true);
+      return;
+    case DIGIT:
+      ScanNumber();
+      return;
+    case ID_START:
+      ScanIdentifier();
+      return;
+    case PUNCTUATION:
+      fsm.AddNextCharToBuffer();
+      fsm.AddBufferToQueue(Token::Type::PUNCTUATION);
+      return;
+    case OPERATOR:
+      ScanOperator();
+      return;
+    default:
+      fsm.ReportError(Diagnostic::Code::UNEXPECTED_SYMBOL,
+                      "exception thrown: unexpected symbol ");
+  }
+}
+
+void TableLexer::SkipBlanks() {
+  LexicAnalyzer& fsm = *state_machine_;
+  for (;;) {
+    fsm.SkipBlanks();
+    if (fsm.cursor_ == fsm.end_ || *fsm.cursor_ != '#') return;
+    fsm.SkipLine();
+  }
+}
+
+void TableLexer::ScanIdentifier() {
+  LexicAnalyzer& fsm = *state_machine_;
+  const char* begin = fsm.cursor_;
+  const char* end = fsm.end_;
+  const char* cursor = begin + Utf8SequenceLength(begin, end);
+  for (;;) {
+    cursor = Scanner::SkipIdentifier(cursor, end);
+    if (cursor == end || static_cast<uint8_t>(*cursor) < 0x80) break;
+    if (!UnicodeClasses::IsIdentifierContinue(DecodeUtf8(cursor, end))) {
+      break;
+    }
+    cursor += Utf8SequenceLength(cursor, end);
+  }
+  fsm.cursor_ = cursor;
+  fsm.token_begin_ = begin;
+  fsm.token_length_ = cursor - begin;
+
+  std::string_view text(begin, cursor - begin);
+  if (!fsm.IsReserved(text)) {
+    fsm.AddIdentifierToQueue();
+  } else if (fsm.IsOperator(text)) {
+    fsm.AddBufferToQueue(Token::Type::OPERATOR);
+  } else {
+    fsm.AddBufferToQueue(Token::Type::RESERVED);
+  }
+}
+
+void TableLexer::ScanNumber() {
+  LexicAnalyzer& fsm = *state_machine_;
+  const char* begin = fsm.cursor_;
+  const char* cursor = begin;
+  NumberState state = INTEGER;
+  for (;;) {
+    NumberClass number_class = ClassifyNumber(cursor);
+    NumberTransition transition =
+        tables_->number_transitions[state][number_class];
+    if (transition.action == CONSUME) {
+      // Every character a number consumes is ASCII; a digit that keeps the
+      // state is followed by as many more as there are.
+      if (number_class == NUM_DIGIT && transition.next == state) {
+        cursor = Scanner::SkipDigits(cursor, fsm.end_);
+      } else {
+        ++cursor;
+      }
+      state = transition.next;
+      continue;
+    }
+    fsm.cursor_ = cursor;
+    switch (transition.action) {
+      case HEX_PREFIX:
+        ++cursor;
+        fsm.cursor_ = cursor;
+        if (std::string_view(begin, cursor - begin) != "0x") {
+          fsm.ReportError(Diagnostic::Code::MALFORMED_NUMBER,
+                          "error: hex value only can start with 0x");
+          return;
+        }
+        number_class = ClassifyNumber(cursor);
+        if (number_class != NUM_DIGIT && number_class != NUM_HEX_LETTER &&
+            number_class != NUM_E) {
+          fsm.ReportError(Diagnostic::Code::MALFORMED_NUMBER,
+                          "error: hex value must have digit after x");
+          return;
+        }
+        state = HEX;
+        continue;
+      case ERROR_AFTER_E:
+        fsm.ReportError(Diagnostic::Code::MALFORMED_NUMBER,
+                        "error: real number must have number after E");
+        return;
+      case ERROR_AFTER_SIGN:
+        fsm.ReportError(Diagnostic::Code::MALFORMED_NUMBER,
+                        "error: unexpected non-digit symbol");
+        return;
+      case ERROR_SECOND_EXPONENT:
+        fsm.ReportError(Diagnostic::Code::MALFORMED_NUMBER,
+                        "Number can have only one exponent");
+        return;
+      case ERROR_FLOAT_EXPONENT:
+        fsm.ReportError(Diagnostic::Code::MALFORMED_NUMBER,
+                        "Expected integer-type number, got float");
+        return;
+      default:
+        break;
+    }
+    fsm.token_begin_ = begin;
+    fsm.token_length_ = cursor - begin;
+    if (transition.action == EMIT_NORMALIZED) {
+      fsm.AddNumberToQueue(NumberParser::Format::DECIMAL);
+    } else {
+      fsm.AddNumberToQueue(state == HEX ? NumberParser::Format::HEX
+                                        : NumberParser::Format::REAL);
+    }
+    return;
+  }
+}
+
+void TableLexer::ScanOperator() {
+  LexicAnalyzer& fsm = *state_machine_;
+  const char* begin = fsm.cursor_;
+  const char* end = fsm.end_;
+  size_t length = Utf8SequenceLength(begin, end);
+  int node = StepOperator(0, begin, length);
+  const char* cursor = begin + length;
+  while (cursor != end) {
+    length = Utf8SequenceLength(cursor, end);
+    int next = StepOperator(node, cursor, length);
+    if (next < 0) break;
+    node = next;
+    cursor += length;
+  }
+  fsm.cursor_ = cursor;
+  fsm.token_begin_ = begin;
+  fsm.token_length_ = cursor - begin;
+  fsm.AddBufferToQueue(Token::Type::OPERATOR);
+}
+
+void TableLexer::ScanLiteral(bool is_char) {
+  LexicAnalyzer& fsm = *state_machine_;
+  const char closing = is_char ? '\'' : '\"';
+  bool read_first_char = false;
+  fsm.token_begin_ = fsm.cursor_;
+  fsm.token_length_ = 0;
+  for (;;) {
+    if (!is_char) fsm.AddStringTextToBuffer();
+    if (!fsm.HasNext() || *fsm.cursor_ == '\n') {
+      fsm.ReportError(Diagnostic::Code::UNTERMINATED_LITERAL,
+                      Diagnostic::kUnterminatedLiteral);
+      return;
+    }
+    char byte = *fsm.cursor_;
+    if (byte == '\\') {
+      if (is_char && read_first_char) {
+        fsm.ReportError(Diagnostic::Code::INVALID_CHAR_LITERAL,
+                        Diagnostic::kCharLiteralError);
+        return;
+      }
+      fsm.SkipChar();
+      read_first_char = true;
+      // A backslash at the end of the line leaves the literal unterminated.
+      if (!fsm.HasNext() || *fsm.cursor_ == '\n') continue;
+      char32_t control = fsm.ToControl(fsm.Peek());
+      if (control == LexerVocabulary::kInvalidEscape) {
+        fsm.ReportError(Diagnostic::Code::INVALID_ESCAPE,
+                        Diagnostic::kUnknownEscape);
+        return;
+      }
+      fsm.AddCharToBuffer(control);
+      fsm.SkipChar();
+      continue;
+    }
+    if (byte != closing) {
+      if (is_char && read_first_char) {
+        fsm.ReportError(Diagnostic::Code::INVALID_CHAR_LITERAL,
+                        Diagnostic::kCharLiteralError);
+        return;
+      }
+      fsm.AddNextCharToBuffer();
+      read_first_char = true;
+      continue;
+    }
+    if (is_char && !read_first_char) {
+      fsm.ReportError(Diagnostic::Code::INVALID_CHAR_LITERAL,
+                      Diagnostic::kCharLiteralError);
+      return;
+    }
+    fsm.SkipChar();
+    fsm.AddBufferToQueue(Token::Type::LITCONSTANT);
+    return;
+  }
+}
@@ -0,0 +1,108 @@
+#ifndef TABLELEXER
+#define TABLELEXER
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class LexicAnalyzer;
+class LexerVocabulary;
+
+// Alternative engine for LexicAnalyzer. The operator and punctuation lists
+// and the character classes of the *State classes are compiled into dense
+// tables once, after which every Execute() lexes one whole token in a tight
+// loop instead of one IState::Execute() call per character. Its
+// output, including errors, matches the state machine exactly.
+class TableLexer {
+ public:
+  struct Tables;
+
+  TableLexer(LexicAnalyzer* fsm, const Tables* tables);
+
+  void Execute();
+
+ private:
+  enum CharClass : uint8_t {
+    OTHER,
+    WHITESPACE,
+    QUOTE,
+    APOSTROPHE,
+    HASH,
+    DIGIT,
+    ID_START,
+    PUNCTUATION,
+    OPERATOR
+  };
+
+  enum NumberClass : uint8_t {
+    NUM_DIGIT,
+    NUM_HEX_LETTER,
+    NUM_E,
+    NUM_X,
+    NUM_DOT,
+    NUM_SIGN,
+    NUM_OTHER,
+    NUM_CLASS_COUNT
+  };
+
+  enum NumberState : uint8_t {
+    INTEGER,
+    HEX,
+    EFOUND,
+    EWAITNUM,
+    EXP,
+    FLOAT,
+    ONLYINTEGER,
+    NUM_STATE_COUNT
+  };
+
+  enum NumberAction : uint8_t {
+    CONSUME,
+    EMIT,
+    EMIT_NORMALIZED,
+    HEX_PREFIX,
+    ERROR_AFTER_E,
+    ERROR_AFTER_SIGN,
+    ERROR_SECOND_EXPONENT,
+    ERROR_FLOAT_EXPONENT
+  };
+
+  struct NumberTransition {
+    NumberAction action;
+    NumberState next;
+  };
+
+ public:
+  // Everything Execute() looks up, derived from a vocabulary only. Each
+  // LexerVocabulary compiles its own once and shares it read-only.
+  struct Tables {
+    explicit Tables(const LexerVocabulary& vocabulary);
+
+    std::array<CharClass, 128> char_classes;
+    std::array<NumberClass, 128> number_classes;
+    std::array<std::array<NumberTransition, NUM_CLASS_COUNT>,
+               NUM_STATE_COUNT>
+        number_transitions;
+    // Byte-level trie over lists/operators.txt; -1 marks a missing edge.
+    std::vector<std::array<int16_t, 256>> operator_transitions;
+    std::vector<bool> operator_accepting;
+  };
+
+ private:
+
+  CharClass Classify(const char* cursor) const;
+  NumberClass ClassifyNumber(const char* cursor) const;
+  int StepOperator(int node, const char* cursor, size_t length) const;
+
+  void SkipBlanks();
+  void ScanIdentifier();
+  void ScanNumber();
+  void ScanOperator();
+  void ScanLiteral(bool is_char);
+
+  LexicAnalyzer* state_machine_;
+  const Tables* tables_;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "TokenBuffer.h"
+
+#include <algorithm>
+
+size_t TokenBuffer::Size() const { return kinds_.size(); }
+
+bool TokenBuffer::IsEmpty() const { return kinds_.empty(); }
+
+void TokenBuffer::Reserve(size_t count) {
+  kinds_.reserve(count);
+  offsets_.reserve(count);
+  lengths_.reserve(count);
+  symbols_.reserve(count);
+  payloads_.reserve(count);
+}
+
+void TokenBuffer::Push(const Token& token) {
+  kinds_.push_back(static_cast<uint8_t>(token.type) |
+                   static_cast<uint8_t>(token.value_type) << 4);
+  offsets_.push_back(token.offset);
+  lengths_.push_back(static_cast<uint32_t>(token.symbol.size()));
+  symbols_.push_back(token.symbol.data());
+  if (token.value_type != Token::ValueType::NONE) {
+    payloads_.push_back(static_cast<uint32_t>(values_.size()));
+    values_.push_back(token.value.integer);
+  } else {
+    payloads_.push_back(token.symbol_id);
+  }
+}
+
+void TokenBuffer::Erase(size_t count) {
+  count = std::min(count, Size());
+  size_t values = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (kinds_[i] >> 4 != 0) ++values;
+  }
+  kinds_.erase(kinds_.begin(), kinds_.begin() + count);
+  offsets_.erase(offsets_.begin(), offsets_.begin() + count);
+  lengths_.erase(lengths_.begin(), lengths_.begin() + count);
+  symbols_.erase(symbols_.begin(), symbols_.begin() + count);
+  payloads_.erase(payloads_.begin(), payloads_.begin() + count);
+  if (values == 0) return;
+  values_.erase(values_.begin(), values_.begin() + values);
+  for (size_t i = 0; i < kinds_.size(); ++i) {
+    if (kinds_[i] >> 4 != 0) payloads_[i] -= static_cast<uint32_t>(values);
+  }
+}
+
+void TokenBuffer::Clear() {
+  kinds_.clear();
+  offsets_.clear();
+  lengths_.clear();
+  symbols_.clear();
+  payloads_.clear();
+  values_.clear();
+}
+
+Token::Type TokenBuffer::GetType(size_t index) const {
+  return static_cast<Token::Type>(kinds_[index] & 0x0F);
+}
+
+uint32_t TokenBuffer::GetOffset(size_t index) const {
+  return offsets_[index];
+}
+
+std::string_view TokenBuffer::GetSymbol(size_t index) const {
+  return std::string_view(symbols_[index], lengths_[index]);
+}
+
+Token TokenBuffer::GetToken(size_t index) const {
+  Token token;
+  token.symbol = GetSymbol(index);
+  token.type = GetType(index);
+  token.value_type = static_cast<Token::ValueType>(kinds_[index] >> 4);
+  token.offset = offsets_[index];
+  if (token.value_type != Token::ValueType::NONE) {
+    token.value.integer = values_[payloads_[index]];
+  } else {
+    token.symbol_id = payloads_[index];
+  }
+  return token;
+}
+
+Token TokenBuffer::operator[](size_t index) const { return GetToken(index); }
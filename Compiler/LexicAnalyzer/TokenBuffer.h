@@ -0,0 +1,45 @@
+#ifndef TOKENBUFFER
+#define TOKENBUFFER
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "Token.h"
+
+// The tokens of an analyzer, stored column by column: a scan over types or
+// offsets touches nothing else, and a token takes 21 bytes instead of the
+// 40 of a Token. Tokens are taken by index in any order, so a parser can
+// look ahead and backtrack freely. Symbols point where the Token symbols
+// pointed, so the buffer must not outlive its analyzer either.
+class TokenBuffer {
+ public:
+  size_t Size() const;
+  bool IsEmpty() const;
+  void Reserve(size_t count);
+  void Push(const Token& token);
+  // Drops the first count tokens.
+  void Erase(size_t count);
+  // Keeps the memory for the next tokens.
+  void Clear();
+
+  Token::Type GetType(size_t index) const;
+  uint32_t GetOffset(size_t index) const;
+  std::string_view GetSymbol(size_t index) const;
+  Token GetToken(size_t index) const;
+  Token operator[](size_t index) const;
+
+ private:
+  // type | value_type << 4, as in a token stream file.
+  std::vector<uint8_t> kinds_;
+  std::vector<uint32_t> offsets_;
+  std::vector<uint32_t> lengths_;
+  std::vector<const char*> symbols_;
+  // symbol_id of an IDENTIFIER, index into values_ of a NUMCONSTANT,
+  // Token::kNoSymbol otherwise.
+  std::vector<uint32_t> payloads_;
+  std::vector<uint64_t> values_;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#include "TokenIterator.h"
+#include "LexicAnalyzer.h"
+
+TokenIterator::TokenIterator() : analyzer_(nullptr), current_token_() {}
+
+TokenIterator::TokenIterator(LexicAnalyzer* analyzer) :
+      analyzer_(analyzer),
+      current_token_() {
+  ++*this;
+}
+
+TokenIterator::reference TokenIterator::operator*() const {
+  return current_token_;
+}
+
+TokenIterator::pointer TokenIterator::operator->() const {
+  return &current_token_;
+}
+
+TokenIterator& TokenIterator::operator++() {
+  if (!analyzer_->NextToken(current_token_)) analyzer_ = nullptr;
+  return *this;
+}
+
+void TokenIterator::operator++(int) { ++*this; }
+
+bool TokenIterator::operator==(const TokenIterator& other) const {
+  return analyzer_ == other.analyzer_;
+}
+
+bool TokenIterator::operator!=(const TokenIterator& other) const {
+  return !(*this == other);
+}
+
+TokenRange::TokenRange(LexicAnalyzer* analyzer) : analyzer_(analyzer) {}
+
+TokenIterator TokenRange::begin() const { return TokenIterator(analyzer_); }
+
+TokenIterator TokenRange::end() const { return TokenIterator(); }
@@ -0,0 +1,48 @@
+#ifndef TOKENITERATOR
+#define TOKENITERATOR
+
+#include <cstddef>
+#include <iterator>
+
+#include "Token.h"
+
+class LexicAnalyzer;
+
+// Input iterator that pulls one token at a time from LexicAnalyzer::NextToken.
+// Lexing errors are thrown from the increment that reaches them.
+class TokenIterator {
+ public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = Token;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const Token*;
+  using reference = const Token&;
+
+  TokenIterator();
+  explicit TokenIterator(LexicAnalyzer* analyzer);
+
+  reference operator*() const;
+  pointer operator->() const;
+  TokenIterator& operator++();
+  void operator++(int);
+
+  bool operator==(const TokenIterator& other) const;
+  bool operator!=(const TokenIterator& other) const;
+
+ private:
+  LexicAnalyzer* analyzer_;
+  Token current_token_;
+};
+
+class TokenRange {
+ public:
+  explicit TokenRange(LexicAnalyzer* analyzer);
+
+  TokenIterator begin() const;
+  TokenIterator end() const;
+
+ private:
+  LexicAnalyzer* analyzer_;
+};
+
+#endif
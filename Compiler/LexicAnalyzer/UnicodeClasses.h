@@ -0,0 +1,53 @@
+#ifndef UNICODECLASSES
+#define UNICODECLASSES
+
+#include <array>
+#include <cstdint>
+
+// Character classes of the language, the same on every platform and in
+// every locale. ASCII is one lookup in a 128-entry table; identifiers may
+// also use any other code point with the XID_Start or XID_Continue
+// property, found by binary search in tables of ranges.
+class UnicodeClasses {
+ public:
+  enum : uint8_t {
+    kDigit = 1 << 0,
+    kHexDigit = 1 << 1,
+    // Letters and '_'.
+    kIdentifierStart = 1 << 2,
+    kIdentifierContinue = 1 << 3
+  };
+
+  static bool IsDigit(char32_t symbol) {
+    return symbol < 0x80 && (kAsciiClasses[symbol] & kDigit) != 0;
+  }
+
+  static bool IsHexDigit(char32_t symbol) {
+    return symbol < 0x80 && (kAsciiClasses[symbol] & kHexDigit) != 0;
+  }
+
+  static bool IsIdentifierStart(char32_t symbol) {
+    if (symbol < 0x80) return (kAsciiClasses[symbol] & kIdentifierStart) != 0;
+    return IsXidStart(symbol);
+  }
+
+  static bool IsIdentifierContinue(char32_t symbol) {
+    if (symbol < 0x80) {
+      return (kAsciiClasses[symbol] & kIdentifierContinue) != 0;
+    }
+    return IsXidContinue(symbol);
+  }
+
+  // Only ASCII letters have a case in the language.
+  static char32_t ToLower(char32_t symbol) {
+    return symbol >= 'A' && symbol <= 'Z' ? symbol | 0x20 : symbol;
+  }
+
+ private:
+  static bool IsXidStart(char32_t symbol);
+  static bool IsXidContinue(char32_t symbol);
+
+  static const std::array<uint8_t, 0x80> kAsciiClasses;
+};
+
+#endif
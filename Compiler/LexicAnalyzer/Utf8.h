@@ -0,0 +1,121 @@
+#ifndef UTF8
+#define UTF8
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Length of the UTF-8 sequence starting at cursor. Malformed or truncated
+// sequences are treated as a single byte so the caller always advances.
+inline size_t Utf8SequenceLength(const char* cursor, const char* end) {
+  unsigned char lead = static_cast<unsigned char>(*cursor);
+  size_t length = 1;
+  if (lead >= 0xF0 && lead < 0xF8) {
+    length = 4;
+  } else if (lead >= 0xE0) {
+    length = lead < 0xF0 ? 3 : 1;
+  } else if (lead >= 0xC2) {
+    length = 2;
+  }
+  if (static_cast<size_t>(end - cursor) < length) return 1;
+  for (size_t i = 1; i < length; ++i) {
+    if ((static_cast<unsigned char>(cursor[i]) & 0xC0) != 0x80) return 1;
+  }
+  return length;
+}
+
+// Whether a sequence of more than one byte by Utf8SequenceLength() is also
+// neither overlong, a surrogate nor above U+10FFFF; its first two bytes
+// tell.
+inline bool IsShortestUtf8(unsigned char lead, unsigned char second) {
+  return !((lead == 0xE0 && second < 0xA0) ||
+           (lead == 0xED && second >= 0xA0) ||
+           (lead == 0xF0 && second < 0x90) ||
+           (lead == 0xF4 && second >= 0x90) || lead > 0xF4);
+}
+
+// Decodes the code point at cursor, U+FFFD for malformed input, which
+// includes everything FindInvalidUtf8() rejects: an overlong '"' must not
+// open a literal.
+inline char32_t DecodeUtf8(const char* cursor, const char* end) {
+  unsigned char lead = static_cast<unsigned char>(*cursor);
+  if (lead < 0x80) return lead;
+  size_t length = Utf8SequenceLength(cursor, end);
+  if (length == 1 ||
+      !IsShortestUtf8(lead, static_cast<unsigned char>(cursor[1]))) {
+    return 0xFFFD;
+  }
+  char32_t code_point = lead & (0x7F >> length);
+  for (size_t i = 1; i < length; ++i) {
+    code_point = (code_point << 6) | (cursor[i] & 0x3F);
+  }
+  return code_point;
+}
+
+// Length and code point of a sequence known to be well-formed, e.g. one
+// before the result of FindInvalidUtf8(); only the lead byte is looked at.
+inline size_t ValidUtf8SequenceLength(const char* cursor) {
+  unsigned char lead = static_cast<unsigned char>(*cursor);
+  if (lead < 0x80) return 1;
+  return lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+}
+
+inline char32_t DecodeValidUtf8(const char* cursor) {
+  unsigned char lead = static_cast<unsigned char>(*cursor);
+  if (lead < 0x80) return lead;
+  size_t length = ValidUtf8SequenceLength(cursor);
+  char32_t code_point = lead & (0x7F >> length);
+  for (size_t i = 1; i < length; ++i) {
+    code_point = (code_point << 6) | (cursor[i] & 0x3F);
+  }
+  return code_point;
+}
+
+// Start of the first sequence in [cursor, end) that is not well-formed
+// UTF-8, or end. Overlong forms, surrogates and code points above U+10FFFF
+// are rejected, as is a sequence cut off by end. ASCII is skipped eight
+// bytes at a time.
+inline const char* FindInvalidUtf8(const char* cursor, const char* end) {
+  while (cursor != end) {
+    uint64_t word;
+    if (end - cursor >= 8) {
+      std::memcpy(&word, cursor, sizeof(word));
+      if ((word & 0x8080808080808080ull) == 0) {
+        cursor += 8;
+        continue;
+      }
+    }
+    unsigned char lead = static_cast<unsigned char>(*cursor);
+    if (lead < 0x80) {
+      ++cursor;
+      continue;
+    }
+    size_t length = Utf8SequenceLength(cursor, end);
+    if (length == 1) return cursor;
+    if (!IsShortestUtf8(lead, static_cast<unsigned char>(cursor[1]))) {
+      return cursor;
+    }
+    cursor += length;
+  }
+  return end;
+}
+
+inline void AppendUtf8(std::string& out, char32_t code_point) {
+  if (code_point < 0x80) {
+    out.push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+#endif
@@ -0,0 +1,121 @@
+#include "Ast.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace {
+
+// Kinds whose token is always the same symbol, which Dump() leaves out.
+bool IsTokenImplied(Ast::Kind kind) {
+  switch (kind) {
+    case Ast::Kind::BLOCK:
+    case Ast::Kind::WHILE:
+    case Ast::Kind::DO_WHILE:
+    case Ast::Kind::FOR:
+    case Ast::Kind::RETURN:
+    case Ast::Kind::EXPRESSION:
+    case Ast::Kind::EMPTY:
+    case Ast::Kind::CALL:
+    case Ast::Kind::INDEX:
+    case Ast::Kind::MEMBER:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+Ast::Ast(TokenBuffer tokens) : tokens_(std::move(tokens)) {
+  // Every node but the root consumes a token of its own, so this is the
+  // only allocation.
+  nodes_.reserve(tokens_.Size() + 1);
+}
+
+uint32_t Ast::GetRoot() const { return 0; }
+
+size_t Ast::Size() const { return nodes_.size(); }
+
+const Ast::Node& Ast::GetNode(uint32_t index) const { return nodes_[index]; }
+
+std::string_view Ast::GetSymbol(uint32_t index) const {
+  uint32_t token = nodes_[index].token;
+  if (token == kNoToken) return std::string_view();
+  return tokens_.GetSymbol(token);
+}
+
+const TokenBuffer& Ast::GetTokens() const { return tokens_; }
+
+uint32_t Ast::AddNode(Kind kind, uint32_t token, uint8_t flags) {
+  nodes_.push_back(Node{kind, flags, token, kNoNode, kNoNode});
+  return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void Ast::SetFirstChild(uint32_t parent, uint32_t child) {
+  nodes_[parent].first_child = child;
+}
+
+void Ast::SetNextSibling(uint32_t node, uint32_t sibling) {
+  nodes_[node].next_sibling = sibling;
+}
+
+void Ast::Dump(std::ostream& output) const {
+  if (nodes_.empty()) return;
+  // Deep trees must not exhaust the call stack.
+  std::vector<std::pair<uint32_t, size_t>> pending = {{GetRoot(), 0}};
+  std::string line;
+  while (!pending.empty()) {
+    auto [index, depth] = pending.back();
+    pending.pop_back();
+    const Node& node = nodes_[index];
+    line.assign(depth * 2, ' ');
+    line += GetKindName(node.kind);
+    if (node.flags & kUnsigned) line += " unsigned";
+    if (node.token != kNoToken && !IsTokenImplied(node.kind)) {
+      line += ' ';
+      line += GetSymbol(index);
+    }
+    if (node.flags & kReference) line += " @";
+    line += '\n';
+    output << line;
+
+    size_t first = pending.size();
+    for (uint32_t child = node.first_child; child != kNoNode;
+         child = nodes_[child].next_sibling) {
+      pending.emplace_back(child, depth + 1);
+    }
+    std::reverse(pending.begin() + first, pending.end());
+  }
+}
+
+const char* Ast::GetKindName(Kind kind) {
+  switch (kind) {
+    case Kind::PROGRAM: return "PROGRAM";
+    case Kind::IMPORT: return "IMPORT";
+    case Kind::FUNCTION: return "FUNCTION";
+    case Kind::PARAMETER: return "PARAMETER";
+    case Kind::TYPE: return "TYPE";
+    case Kind::BLOCK: return "BLOCK";
+    case Kind::DECLARATION: return "DECLARATION";
+    case Kind::IF: return "IF";
+    case Kind::WHILE: return "WHILE";
+    case Kind::DO_WHILE: return "DO_WHILE";
+    case Kind::FOR: return "FOR";
+    case Kind::RETURN: return "RETURN";
+    case Kind::JUMP: return "JUMP";
+    case Kind::EXPRESSION: return "EXPRESSION";
+    case Kind::EMPTY: return "EMPTY";
+    case Kind::BINARY: return "BINARY";
+    case Kind::PREFIX: return "PREFIX";
+    case Kind::POSTFIX: return "POSTFIX";
+    case Kind::CALL: return "CALL";
+    case Kind::INDEX: return "INDEX";
+    case Kind::MEMBER: return "MEMBER";
+    case Kind::NAME: return "NAME";
+    case Kind::NUMBER: return "NUMBER";
+    case Kind::LITERAL: return "LITERAL";
+    case Kind::NIL: return "NIL";
+  }
+  return "UNKNOWN";
+}
@@ -0,0 +1,117 @@
+#ifndef AST
+#define AST
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "Token.h"
+#include "TokenBuffer.h"
+
+// Syntax tree of one source. Nodes live in one array and refer to each
+// other and to their tokens by 32-bit index: a node is 16 bytes, the whole
+// tree is a single allocation when the array is reserved from the token
+// count, and indices survive the array growing. Children of a node are a
+// list through first_child and next_sibling, in source order. The tree
+// owns the tokens it was parsed from; their symbols still point into the
+// analyzer, so the tree must not outlive it.
+class Ast {
+ public:
+  static constexpr uint32_t kNoNode = UINT32_MAX;
+  static constexpr uint32_t kNoToken = UINT32_MAX;
+
+  // Each kind's comment gives its token, then its children in order, '-'
+  // for none; children in [] are left out when missing.
+  enum class Kind : uint8_t {
+    // -, declarations and statements.
+    PROGRAM,
+    // The path literal, -.
+    IMPORT,
+    // The name, PARAMETER..., [TYPE] of the result, BLOCK.
+    FUNCTION,
+    // The name, [TYPE].
+    PARAMETER,
+    // The type name, -. See Flags.
+    TYPE,
+    // '{', statements.
+    BLOCK,
+    // let, const or var, NAME, [TYPE], [initializer].
+    DECLARATION,
+    // if or elif, condition, statement, [else statement]; an elif is the
+    // else statement of its if.
+    IF,
+    // while, condition, statement.
+    WHILE,
+    // do, statement, condition.
+    DO_WHILE,
+    // for, initializer, condition and step, each EMPTY when left out,
+    // statement.
+    FOR,
+    // return, [value].
+    RETURN,
+    // break or continue, -.
+    JUMP,
+    // ';', expression.
+    EXPRESSION,
+    // A left out part of a for or a lone ';', -.
+    EMPTY,
+    // The operator, left, right. Assignments too.
+    BINARY,
+    // The operator, operand.
+    PREFIX,
+    POSTFIX,
+    // '(', callee, arguments.
+    CALL,
+    // '[', target, index.
+    INDEX,
+    // "->", object, NAME.
+    MEMBER,
+    // Leaves, -.
+    NAME,
+    NUMBER,
+    LITERAL,
+    // NIL or NULL.
+    NIL
+  };
+
+  // Of a TYPE.
+  enum Flags : uint8_t {
+    kUnsigned = 1 << 0,
+    // Marked with '@', as in "LexicAnalyzer @fsm".
+    kReference = 1 << 1
+  };
+
+  struct Node {
+    Kind kind;
+    uint8_t flags;
+    uint32_t token;
+    uint32_t first_child;
+    uint32_t next_sibling;
+  };
+
+  explicit Ast(TokenBuffer tokens);
+
+  // The root is the first node added, a PROGRAM once parsed.
+  uint32_t GetRoot() const;
+  size_t Size() const;
+  const Node& GetNode(uint32_t index) const;
+  // Empty for nodes without a token.
+  std::string_view GetSymbol(uint32_t index) const;
+  const TokenBuffer& GetTokens() const;
+
+  uint32_t AddNode(Kind kind, uint32_t token, uint8_t flags = 0);
+  void SetFirstChild(uint32_t parent, uint32_t child);
+  void SetNextSibling(uint32_t node, uint32_t sibling);
+
+  // One node per line, children indented under their parent.
+  void Dump(std::ostream& output) const;
+  static const char* GetKindName(Kind kind);
+
+ private:
+  TokenBuffer tokens_;
+  std::vector<Node> nodes_;
+};
+
+#endif
@@ -0,0 +1,489 @@
+#include "Parser.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+#pragma region PRECEDENCE
+// Binding powers from loosest to tightest. Prefix operators bind tighter
+// than every binary operator but "**", so -a ** b is -(a ** b).
+enum Power {
+  kNone = 0,
+  kAssignment,
+  kOr,
+  kAnd,
+  kBitOr,
+  kBitXor,
+  kBitAnd,
+  kEquality,
+  kComparison,
+  kShift,
+  kSum,
+  kProduct,
+  kPrefix,
+  kExponent,
+  kPostfix
+};
+
+struct Infix {
+  std::string_view symbol;
+  Power power;
+  bool is_right_associative;
+};
+
+const Infix kInfixOperators[] = {
+    {"=", kAssignment, true},   {"+=", kAssignment, true},
+    {"-=", kAssignment, true},  {"*=", kAssignment, true},
+    {"/=", kAssignment, true},  {"//=", kAssignment, true},
+    {"%=", kAssignment, true},  {"**=", kAssignment, true},
+    {"^=", kAssignment, true},  {"&=", kAssignment, true},
+    {"|=", kAssignment, true},  {"<<=", kAssignment, true},
+    {">>=", kAssignment, true}, {"->=", kAssignment, true},
+    {"||", kOr, false},         {"or", kOr, false},
+    {"&&", kAnd, false},        {"and", kAnd, false},
+    {"|", kBitOr, false},       {"^", kBitXor, false},
+    {"&", kBitAnd, false},      {"==", kEquality, false},
+    {"<", kComparison, false},  {"<=", kComparison, false},
+    {">", kComparison, false},  {">=", kComparison, false},
+    {"<<", kShift, false},      {">>", kShift, false},
+    {"+", kSum, false},         {"-", kSum, false},
+    {"*", kProduct, false},     {"/", kProduct, false},
+    {"//", kProduct, false},    {"%", kProduct, false},
+    {"**", kExponent, true}};
+
+const std::string_view kPrefixOperators[] = {
+    "-", "+", "!", "~", "not", "++", "--", "@", "$", "&", "*"};
+
+const std::string_view kTypeNames[] = {"int8",   "int16", "int32", "int64",
+                                       "double", "float", "char",  "void"};
+
+const Infix* FindInfix(std::string_view symbol) {
+  for (const Infix& infix : kInfixOperators) {
+    if (infix.symbol == symbol) return &infix;
+  }
+  return nullptr;
+}
+
+bool IsPrefixOperator(std::string_view symbol) {
+  for (std::string_view prefix : kPrefixOperators) {
+    if (prefix == symbol) return true;
+  }
+  return false;
+}
+#pragma endregion PRECEDENCE
+
+}  // namespace
+
+Parser::Parser(LexicAnalyzer& analyzer) :
+      analyzer_(&analyzer),
+      ast_(analyzer.GetTokens()),
+      position_(0),
+      depth_(0) {}
+
+Ast Parser::Parse() {
+  uint32_t program = AddNode(Ast::Kind::PROGRAM, Ast::kNoToken);
+  Children children;
+  while (!IsAtEnd()) {
+    if (IsAt("import")) {
+      AddChild(program, children, ParseImport());
+    } else if (IsAt("func")) {
+      AddChild(program, children, ParseFunction());
+    } else {
+      AddChild(program, children, ParseStatement());
+    }
+  }
+  return std::move(ast_);
+}
+
+#pragma region DECLARATIONS
+uint32_t Parser::ParseImport() {
+  Take();
+  if (IsAtEnd() || GetType() != Token::Type::LITCONSTANT) {
+    ThrowError("error: expected a path after import");
+  }
+  uint32_t import = AddNode(Ast::Kind::IMPORT, Take());
+  Accept(";");
+  return import;
+}
+
+uint32_t Parser::ParseFunction() {
+  Enter();
+  Take();
+  uint32_t function = AddNode(Ast::Kind::FUNCTION, ExpectIdentifier());
+  Children children;
+  Expect("(");
+  // "(void)" declares no parameters.
+  if (IsAt("void") && position_ + 1 < ast_.GetTokens().Size() &&
+      ast_.GetTokens().GetSymbol(position_ + 1) == ")") {
+    Take();
+  }
+  if (!IsAt(")")) {
+    do {
+      AddChild(function, children, ParseParameter());
+    } while (Accept(","));
+  }
+  Expect(")");
+  if (Accept(":")) AddChild(function, children, ParseType());
+  if (!IsAt("{")) ThrowError("error: expected '{' before function body");
+  AddChild(function, children, ParseBlock());
+  Leave();
+  return function;
+}
+
+uint32_t Parser::ParseParameter() {
+  // "name" alone or a type before it, as in "LexicAnalyzer @fsm".
+  const TokenBuffer& tokens = ast_.GetTokens();
+  bool has_type = IsTypeName() || IsAt("unsigned");
+  if (!has_type && !IsAtEnd() && GetType() == Token::Type::IDENTIFIER &&
+      position_ + 1 < tokens.Size()) {
+    Token::Type next_type = tokens.GetType(position_ + 1);
+    std::string_view next = tokens.GetSymbol(position_ + 1);
+    has_type = next_type == Token::Type::IDENTIFIER ||
+               (next_type == Token::Type::OPERATOR && next == "@");
+  }
+  uint32_t type = has_type ? ParseType() : Ast::kNoNode;
+  uint32_t parameter = AddNode(Ast::Kind::PARAMETER, ExpectIdentifier());
+  if (type != Ast::kNoNode) ast_.SetFirstChild(parameter, type);
+  return parameter;
+}
+
+uint32_t Parser::ParseType() {
+  uint8_t flags = Accept("unsigned") ? Ast::kUnsigned : 0;
+  if (!IsTypeName() &&
+      (IsAtEnd() || GetType() != Token::Type::IDENTIFIER)) {
+    ThrowError("error: expected a type");
+  }
+  uint32_t name = Take();
+  if (Accept("@")) flags |= Ast::kReference;
+  return AddNode(Ast::Kind::TYPE, name, flags);
+}
+#pragma endregion DECLARATIONS
+
+#pragma region STATEMENTS
+uint32_t Parser::ParseStatement() {
+  if (IsAtEnd()) ThrowError("error: expected a statement");
+  Enter();
+  uint32_t statement;
+  if (IsAt("{")) {
+    statement = ParseBlock();
+  } else if (IsAt("let") || IsAt("const") || IsAt("var")) {
+    statement = ParseDeclaration();
+  } else if (IsAt("if")) {
+    statement = ParseIf();
+  } else if (IsAt("while")) {
+    statement = ParseWhile();
+  } else if (IsAt("do")) {
+    statement = ParseDoWhile();
+  } else if (IsAt("for")) {
+    statement = ParseFor();
+  } else if (IsAt("return")) {
+    statement = ParseReturn();
+  } else if (IsAt("break") || IsAt("continue")) {
+    statement = ParseJump();
+  } else if (IsAt(";")) {
+    statement = AddNode(Ast::Kind::EMPTY, Take());
+  } else {
+    statement = ParseExpressionStatement();
+  }
+  Leave();
+  return statement;
+}
+
+uint32_t Parser::ParseBlock() {
+  uint32_t block = AddNode(Ast::Kind::BLOCK, Expect("{"));
+  Children children;
+  while (!IsAt("}")) {
+    if (IsAtEnd()) ThrowError("error: closing bracket } is not found");
+    AddChild(block, children, ParseStatement());
+  }
+  Take();
+  return block;
+}
+
+uint32_t Parser::ParseDeclaration() {
+  uint32_t declaration = AddNode(Ast::Kind::DECLARATION, Take());
+  Children children;
+  AddChild(declaration, children,
+           AddNode(Ast::Kind::NAME, ExpectIdentifier()));
+  if (Accept(":")) AddChild(declaration, children, ParseType());
+  if (Accept("=")) AddChild(declaration, children, ParseExpression());
+  Expect(";");
+  return declaration;
+}
+
+uint32_t Parser::ParseIf() {
+  // The elif chain is flat in the source, so it is parsed in a loop: each
+  // elif is an IF node hung as the last child of the previous branch.
+  uint32_t statement = AddNode(Ast::Kind::IF, Take());
+  uint32_t branch = statement;
+  for (;;) {
+    Children children;
+    AddChild(branch, children, ParseParenthesized());
+    AddChild(branch, children, ParseStatement());
+    if (!IsAt("elif")) {
+      if (Accept("else")) AddChild(branch, children, ParseStatement());
+      return statement;
+    }
+    uint32_t next = AddNode(Ast::Kind::IF, Take());
+    AddChild(branch, children, next);
+    branch = next;
+  }
+}
+
+uint32_t Parser::ParseWhile() {
+  uint32_t statement = AddNode(Ast::Kind::WHILE, Take());
+  Children children;
+  AddChild(statement, children, ParseParenthesized());
+  AddChild(statement, children, ParseStatement());
+  return statement;
+}
+
+uint32_t Parser::ParseDoWhile() {
+  uint32_t statement = AddNode(Ast::Kind::DO_WHILE, Take());
+  Children children;
+  AddChild(statement, children, ParseStatement());
+  Expect("while");
+  AddChild(statement, children, ParseParenthesized());
+  Expect(";");
+  return statement;
+}
+
+uint32_t Parser::ParseFor() {
+  uint32_t statement = AddNode(Ast::Kind::FOR, Take());
+  Children children;
+  Expect("(");
+  if (IsAt("let") || IsAt("const") || IsAt("var")) {
+    // Takes its ';'.
+    AddChild(statement, children, ParseDeclaration());
+  } else if (IsAt(";")) {
+    AddChild(statement, children, AddNode(Ast::Kind::EMPTY, Take()));
+  } else {
+    AddChild(statement, children, ParseExpressionStatement());
+  }
+  if (IsAt(";")) {
+    AddChild(statement, children, AddNode(Ast::Kind::EMPTY, Take()));
+  } else {
+    AddChild(statement, children, ParseExpression());
+    Expect(";");
+  }
+  if (IsAt(")")) {
+    AddChild(statement, children, AddNode(Ast::Kind::EMPTY, Take()));
+  } else {
+    AddChild(statement, children, ParseExpression());
+    Expect(")");
+  }
+  AddChild(statement, children, ParseStatement());
+  return statement;
+}
+
+uint32_t Parser::ParseReturn() {
+  uint32_t statement = AddNode(Ast::Kind::RETURN, Take());
+  if (!IsAt(";")) ast_.SetFirstChild(statement, ParseExpression());
+  Expect(";");
+  return statement;
+}
+
+uint32_t Parser::ParseJump() {
+  uint32_t statement = AddNode(Ast::Kind::JUMP, Take());
+  Expect(";");
+  return statement;
+}
+
+uint32_t Parser::ParseExpressionStatement() {
+  uint32_t expression = ParseExpression();
+  uint32_t statement = AddNode(Ast::Kind::EXPRESSION, Expect(";"));
+  ast_.SetFirstChild(statement, expression);
+  return statement;
+}
+#pragma endregion STATEMENTS
+
+#pragma region EXPRESSIONS
+uint32_t Parser::ParseExpression(int min_power) {
+  Enter();
+  uint32_t left = ParsePrefix();
+  while (!IsAtEnd()) {
+    Token::Type type = GetType();
+    if (type != Token::Type::OPERATOR && type != Token::Type::PUNCTUATION) {
+      break;
+    }
+    std::string_view symbol = GetSymbol();
+    if (symbol == "(" || symbol == "[" || symbol == "->" || symbol == "++" ||
+        symbol == "--") {
+      if (kPostfix <= min_power) break;
+      uint32_t token = Take();
+      uint32_t node;
+      if (symbol == "(") {
+        node = AddNode(Ast::Kind::CALL, token);
+        Children children;
+        AddChild(node, children, left);
+        if (!IsAt(")")) {
+          do {
+            AddChild(node, children, ParseExpression());
+          } while (Accept(","));
+        }
+        Expect(")");
+      } else if (symbol == "[") {
+        node = AddNode(Ast::Kind::INDEX, token);
+        Children children;
+        AddChild(node, children, left);
+        AddChild(node, children, ParseExpression());
+        Expect("]");
+      } else if (symbol == "->") {
+        node = AddNode(Ast::Kind::MEMBER, token);
+        Children children;
+        AddChild(node, children, left);
+        AddChild(node, children,
+                 AddNode(Ast::Kind::NAME, ExpectIdentifier()));
+      } else {
+        node = AddNode(Ast::Kind::POSTFIX, token);
+        ast_.SetFirstChild(node, left);
+      }
+      left = node;
+      continue;
+    }
+    const Infix* infix =
+        type == Token::Type::OPERATOR ? FindInfix(symbol) : nullptr;
+    if (infix == nullptr || infix->power <= min_power) break;
+    uint32_t node = AddNode(Ast::Kind::BINARY, Take());
+    // A right-associative operator lets one of its own power follow.
+    uint32_t right = ParseExpression(infix->is_right_associative
+                                         ? infix->power - 1
+                                         : infix->power);
+    Children children;
+    AddChild(node, children, left);
+    AddChild(node, children, right);
+    left = node;
+  }
+  Leave();
+  return left;
+}
+
+uint32_t Parser::ParsePrefix() {
+  if (IsAtEnd()) ThrowError("error: expected an expression");
+  switch (GetType()) {
+    case Token::Type::IDENTIFIER:
+      return AddNode(Ast::Kind::NAME, Take());
+    case Token::Type::NUMCONSTANT:
+      return AddNode(Ast::Kind::NUMBER, Take());
+    case Token::Type::LITCONSTANT:
+      return AddNode(Ast::Kind::LITERAL, Take());
+    case Token::Type::RESERVED:
+      if (IsAt("NIL") || IsAt("NULL")) return AddNode(Ast::Kind::NIL, Take());
+      break;
+    case Token::Type::PUNCTUATION:
+      if (IsAt("(")) return ParseParenthesized();
+      break;
+    case Token::Type::OPERATOR:
+      if (IsPrefixOperator(GetSymbol())) {
+        uint32_t node = AddNode(Ast::Kind::PREFIX, Take());
+        ast_.SetFirstChild(node, ParseExpression(kPrefix));
+        return node;
+      }
+      break;
+    default:
+      break;
+  }
+  ThrowError("error: expected an expression");
+}
+
+uint32_t Parser::ParseParenthesized() {
+  Expect("(");
+  uint32_t expression = ParseExpression();
+  Expect(")");
+  return expression;
+}
+#pragma endregion EXPRESSIONS
+
+#pragma region TOKENS
+bool Parser::IsAtEnd() const { return position_ == ast_.GetTokens().Size(); }
+
+Token::Type Parser::GetType() const {
+  return ast_.GetTokens().GetType(position_);
+}
+
+std::string_view Parser::GetSymbol() const {
+  return ast_.GetTokens().GetSymbol(position_);
+}
+
+bool Parser::IsAt(std::string_view symbol) const {
+  if (IsAtEnd()) return false;
+  Token::Type type = GetType();
+  return (type == Token::Type::RESERVED || type == Token::Type::OPERATOR ||
+          type == Token::Type::PUNCTUATION) &&
+         GetSymbol() == symbol;
+}
+
+bool Parser::IsTypeName() const {
+  if (IsAtEnd() || GetType() != Token::Type::RESERVED) return false;
+  for (std::string_view name : kTypeNames) {
+    if (GetSymbol() == name) return true;
+  }
+  return false;
+}
+
+uint32_t Parser::Take() { return static_cast<uint32_t>(position_++); }
+
+bool Parser::Accept(std::string_view symbol) {
+  if (!IsAt(symbol)) return false;
+  ++position_;
+  return true;
+}
+
+uint32_t Parser::Expect(std::string_view symbol) {
+  if (!IsAt(symbol)) {
+    std::string message = "error: expected " + std::string(symbol);
+    ThrowError(message.c_str());
+  }
+  return Take();
+}
+
+uint32_t Parser::ExpectIdentifier() {
+  if (IsAtEnd() || GetType() != Token::Type::IDENTIFIER) {
+    ThrowError("error: expected an identifier");
+  }
+  return Take();
+}
+#pragma endregion TOKENS
+
+uint32_t Parser::AddNode(Ast::Kind kind, uint32_t token, uint8_t flags) {
+  return ast_.AddNode(kind, token, flags);
+}
+
+void Parser::AddChild(uint32_t parent, Children& children, uint32_t child) {
+  if (children.last == Ast::kNoNode) {
+    ast_.SetFirstChild(parent, child);
+  } else {
+    ast_.SetNextSibling(children.last, child);
+  }
+  children.last = child;
+}
+
+void Parser::Enter() {
+  if (++depth_ > kMaxDepth) ThrowError("error: nesting is too deep");
+}
+
+void Parser::Leave() { --depth_; }
+
+void Parser::ThrowError(const char* message) const {
+  const TokenBuffer& tokens = ast_.GetTokens();
+  std::string full_error_message = "PARSER ERROR!\n";
+  full_error_message += message;
+  full_error_message.push_back('\n');
+  if (tokens.IsEmpty()) {
+    full_error_message += "at the end of an empty file";
+    throw std::runtime_error(full_error_message);
+  }
+  // Past the last token the error is reported at it.
+  size_t position = IsAtEnd() ? tokens.Size() - 1 : position_;
+  LineIndex::Location location =
+      analyzer_->GetLocation(tokens.GetOffset(position));
+  full_error_message += "at line " + std::to_string(location.line)
+                     + " char " + std::to_string(location.column)
+                     + " \"";
+  full_error_message += IsAtEnd() ? std::string_view("eof")
+                                  : tokens.GetSymbol(position);
+  full_error_message += "\"";
+  throw std::runtime_error(full_error_message);
+}
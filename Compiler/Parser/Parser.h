@@ -0,0 +1,87 @@
+#ifndef PARSER
+#define PARSER
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "Ast.h"
+#include "LexicAnalyzer.h"
+#include "Token.h"
+#include "TokenBuffer.h"
+
+// Recursive descent over the statements of the language of
+// lexic_analyzer_tests_/full/*, with an operator-precedence (Pratt) loop
+// for expressions; see Ast for what is built. Tokens are taken by index,
+// so looking ahead costs nothing. The first syntax error throws, and so
+// does nesting deeper than kMaxDepth, before it can exhaust the stack.
+class Parser {
+ public:
+  static constexpr size_t kMaxDepth = 512;
+
+  // Takes all of the analyzer's remaining tokens, which throws on a lexic
+  // error unless the analyzer records them; ERROR tokens are syntax errors.
+  explicit Parser(LexicAnalyzer& analyzer);
+
+  Ast Parse();
+
+ private:
+  // A list of children under construction.
+  struct Children {
+    uint32_t last = Ast::kNoNode;
+  };
+
+  #pragma region DECLARATIONS
+  uint32_t ParseImport();
+  uint32_t ParseFunction();
+  uint32_t ParseParameter();
+  uint32_t ParseType();
+  #pragma endregion DECLARATIONS
+
+  #pragma region STATEMENTS
+  uint32_t ParseStatement();
+  uint32_t ParseBlock();
+  uint32_t ParseDeclaration();
+  uint32_t ParseIf();
+  uint32_t ParseWhile();
+  uint32_t ParseDoWhile();
+  uint32_t ParseFor();
+  uint32_t ParseReturn();
+  uint32_t ParseJump();
+  uint32_t ParseExpressionStatement();
+  #pragma endregion STATEMENTS
+
+  #pragma region EXPRESSIONS
+  // Parses operators binding tighter than min_power.
+  uint32_t ParseExpression(int min_power = 0);
+  uint32_t ParsePrefix();
+  uint32_t ParseParenthesized();
+  #pragma endregion EXPRESSIONS
+
+  #pragma region TOKENS
+  bool IsAtEnd() const;
+  Token::Type GetType() const;
+  std::string_view GetSymbol() const;
+  // Whether the next token is the keyword, operator or punctuation symbol.
+  bool IsAt(std::string_view symbol) const;
+  bool IsTypeName() const;
+  uint32_t Take();
+  // Takes the next token when it is symbol.
+  bool Accept(std::string_view symbol);
+  uint32_t Expect(std::string_view symbol);
+  uint32_t ExpectIdentifier();
+  #pragma endregion TOKENS
+
+  uint32_t AddNode(Ast::Kind kind, uint32_t token, uint8_t flags = 0);
+  void AddChild(uint32_t parent, Children& children, uint32_t child);
+  void Enter();
+  void Leave();
+  [[noreturn]] void ThrowError(const char* message) const;
+
+  LexicAnalyzer* analyzer_;
+  Ast ast_;
+  size_t position_;
+  size_t depth_;
+};
+
+#endif
@@ -1,19 +1,45 @@
 #ifndef TOKEN
 #define TOKEN
 
-#include <string>
+#include <cstdint>
+#include <string_view>
 
+// symbol is UTF-8 and points either into the analyzed source or into storage
+// owned by the LexicAnalyzer, so tokens must not outlive their analyzer.
 struct Token {
-  enum class Type {
+  enum class Type : uint8_t {
     RESERVED,
     IDENTIFIER,
     NUMCONSTANT,
     LITCONSTANT,
     OPERATOR,
-    PUNCTUATION
+    PUNCTUATION,
+    // Text skipped after a recorded Diagnostic.
+    ERROR
   };
-  std::wstring symbol;
+  // Which member of value a NUMCONSTANT carries: decimal and hex literals
+  // are INTEGER, literals with a '.' or an exponent are REAL.
+  enum class ValueType : uint8_t {
+    NONE,
+    INTEGER,
+    REAL
+  };
+  // symbol_id of every token but an IDENTIFIER.
+  static constexpr uint32_t kNoSymbol = UINT32_MAX;
+
+  std::string_view symbol;
   Type type;
+  ValueType value_type = ValueType::NONE;
+  // Id of an IDENTIFIER's text in the analyzer's StringInterner.
+  uint32_t symbol_id = kNoSymbol;
+  // Byte offset of the token's first character, an opening quote for
+  // literals, in the analyzed source; LexicAnalyzer::GetLocation() turns
+  // it into line and column.
+  uint32_t offset = 0;
+  union {
+    uint64_t integer;
+    double real;
+  } value = {0};
 };
 
-#endif
\ No newline at end of file
+#endif
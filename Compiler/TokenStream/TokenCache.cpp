@@ -0,0 +1,184 @@
+#include "TokenCache.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Hash.h"
+
+namespace {
+
+const std::string kExtension = ".tokens.bin";
+const size_t kKeyLength = 16;
+
+}  // namespace
+
+TokenCache::TokenCache(const std::string& directory,
+                       const LexerVocabulary& vocabulary,
+                       uint64_t max_size) :
+      directory_(directory),
+      seed_(vocabulary.GetFingerprint()),
+      max_size_(max_size) {
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  if (!std::filesystem::is_directory(directory_, error)) {
+    throw std::runtime_error(
+        "exception thrown: unable to create token cache " + directory);
+  }
+
+  #pragma region SCAN
+  std::vector<std::pair<std::filesystem::file_time_type, Entry>> found;
+  for (const auto& file :
+       std::filesystem::directory_iterator(directory_, error)) {
+    std::string name = file.path().filename().string();
+    if (name.size() != kKeyLength + kExtension.size() ||
+        name.compare(kKeyLength, std::string::npos, kExtension) != 0) {
+      continue;
+    }
+    Entry entry;
+    auto parsed = std::from_chars(name.data(), name.data() + kKeyLength,
+                                  entry.key, 16);
+    if (parsed.ptr != name.data() + kKeyLength) continue;
+    entry.size = file.file_size(error);
+    if (error) continue;
+    found.emplace_back(file.last_write_time(error), entry);
+  }
+  std::sort(found.begin(), found.end(),
+            [](const auto& left, const auto& right) {
+              return left.first > right.first;
+            });
+  for (const auto& file : found) {
+    entries_.push_back(file.second);
+    index_[file.second.key] = std::prev(entries_.end());
+    stats_.size += file.second.size;
+  }
+  #pragma endregion SCAN
+
+  Evict();
+}
+
+uint64_t TokenCache::GetKey(const SourceBuffer& source,
+                            LexicAnalyzer::Engine engine) const {
+  // The engines agree on valid sources, but an entry must not hide a
+  // difference between them.
+  char engine_id = static_cast<char>(engine);
+  return HashBytes(source.Begin(), source.Size(),
+                   HashBytes(&engine_id, 1, seed_));
+}
+
+std::unique_ptr<TokenStreamReader> TokenCache::Find(uint64_t key) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index_.find(key) == index_.end()) {
+      ++stats_.misses;
+      return nullptr;
+    }
+  }
+  std::string path = GetPath(key);
+  std::unique_ptr<TokenStreamReader> reader;
+  try {
+    reader = std::make_unique<TokenStreamReader>(path);
+  } catch (const std::runtime_error&) {
+    reader = nullptr;
+  }
+
+  bool is_indexed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Another thread may have stored or evicted the entry in between.
+    auto entry = index_.find(key);
+    is_indexed = entry != index_.end();
+    if (!reader) {
+      // Written by another version or damaged, the next Store replaces it.
+      if (is_indexed) Remove(entry->second);
+      ++stats_.misses;
+      return nullptr;
+    }
+    if (is_indexed) {
+      entries_.splice(entries_.begin(), entries_, entry->second);
+    }
+    ++stats_.hits;
+  }
+  if (is_indexed) {
+    std::error_code error;
+    std::filesystem::last_write_time(
+        path, std::filesystem::file_time_type::clock::now(), error);
+  }
+  return reader;
+}
+
+bool TokenCache::Store(uint64_t key, const TokenStreamWriter& writer) {
+  std::string path = GetPath(key);
+  // Readers only ever see complete files.
+  std::string temporary = path + '.' +
+                          std::to_string(std::hash<std::thread::id>()(
+                              std::this_thread::get_id())) +
+                          ".tmp";
+  std::error_code error;
+  {
+    std::ofstream output(temporary, std::ios::out | std::ios::binary);
+    if (!output.is_open()) return false;
+    writer.Write(output);
+    output.close();
+    if (!output) {
+      std::filesystem::remove(temporary, error);
+      return false;
+    }
+  }
+  std::filesystem::rename(temporary, path, error);
+  if (error) {
+    std::filesystem::remove(temporary, error);
+    return false;
+  }
+  uint64_t size = std::filesystem::file_size(path, error);
+  if (error) return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto entry = index_.find(key);
+  if (entry != index_.end()) {
+    stats_.size -= entry->second->size;
+    entries_.erase(entry->second);
+  }
+  entries_.push_front(Entry{key, size});
+  index_[key] = entries_.begin();
+  stats_.size += size;
+  ++stats_.stores;
+  Evict();
+  return true;
+}
+
+TokenCache::Stats TokenCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.entries = entries_.size();
+  return stats;
+}
+
+std::string TokenCache::GetPath(uint64_t key) const {
+  char name[kKeyLength + 1];
+  std::snprintf(name, sizeof(name), "%016llx",
+                static_cast<unsigned long long>(key));
+  return (std::filesystem::path(directory_) / (name + kExtension)).string();
+}
+
+void TokenCache::Remove(std::list<Entry>::iterator entry) {
+  std::error_code error;
+  std::filesystem::remove(GetPath(entry->key), error);
+  stats_.size -= entry->size;
+  index_.erase(entry->key);
+  entries_.erase(entry);
+}
+
+void TokenCache::Evict() {
+  while (stats_.size > max_size_ && !entries_.empty()) {
+    Remove(std::prev(entries_.end()));
+    ++stats_.evictions;
+  }
+}
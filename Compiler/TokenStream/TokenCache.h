@@ -0,0 +1,71 @@
+#ifndef TOKENCACHE
+#define TOKENCACHE
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "LexerVocabulary.h"
+#include "LexicAnalyzer.h"
+#include "SourceBuffer.h"
+#include "TokenStreamReader.h"
+#include "TokenStreamWriter.h"
+
+// Token files of already lexed sources, kept in a directory and keyed by a
+// hash of the source bytes, of the vocabulary and of the engine. Entries
+// over max_size are evicted least recently used first; file modification
+// times carry the order over to the next run. Safe to use from several
+// threads, and several processes may share a directory since entries are
+// renamed into place. Cached tokens come from a TokenStreamReader, so
+// their symbol_id is not an interner id.
+class TokenCache {
+ public:
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t stores = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    uint64_t size = 0;
+  };
+
+  static constexpr uint64_t kDefaultMaxSize = uint64_t{256} << 20;
+
+  // Creates directory when it does not exist yet, throws when it can not.
+  TokenCache(const std::string& directory, const LexerVocabulary& vocabulary,
+             uint64_t max_size = kDefaultMaxSize);
+
+  uint64_t GetKey(const SourceBuffer& source,
+                  LexicAnalyzer::Engine engine) const;
+  // Null on a miss, including entries that turn out to be unreadable. The
+  // file is opened and mapped without holding the lock.
+  std::unique_ptr<TokenStreamReader> Find(uint64_t key);
+  // Returns false when the entry could not be written, which only costs
+  // a future miss.
+  bool Store(uint64_t key, const TokenStreamWriter& writer);
+  Stats GetStats() const;
+
+ private:
+  struct Entry {
+    uint64_t key;
+    uint64_t size;
+  };
+
+  std::string GetPath(uint64_t key) const;
+  void Remove(std::list<Entry>::iterator entry);
+  void Evict();
+
+  std::string directory_;
+  uint64_t seed_;
+  uint64_t max_size_;
+  mutable std::mutex mutex_;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+  Stats stats_;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef TOKENSTREAMFORMAT
+#define TOKENSTREAMFORMAT
+
+#include <cstddef>
+#include <cstdint>
+
+// Layout of a binary token file, little-endian. The header is followed by
+// these sections, each starting on an 8 byte boundary:
+//   uint8_t  kinds[token_count]      Token::Type | Token::ValueType << 4
+//   uint32_t offsets[token_count]    Token::offset
+//   uint32_t strings[token_count]    index of Token::symbol in the pool
+//   uint64_t values[string_count]    Token::value of a number with that text
+//   uint32_t bounds[string_count + 1]
+//   char     pool[pool_size]         string i is pool[bounds[i], bounds[i+1])
+// Equal symbols are stored once, so a token's length is the length of its
+// pool string.
+struct TokenStreamHeader {
+  static constexpr char kMagic[4] = {'L', 'X', 'T', 'K'};
+  static constexpr uint32_t kVersion = 1;
+
+  char magic[4];
+  uint32_t version;
+  uint32_t token_count;
+  uint32_t string_count;
+  uint32_t pool_size;
+  uint32_t reserved[3];
+};
+
+static_assert(sizeof(TokenStreamHeader) == 32,
+              "the header is part of the file format");
+
+inline size_t AlignTokenStreamSection(size_t size) {
+  return (size + 7) & ~static_cast<size_t>(7);
+}
+
+#endif
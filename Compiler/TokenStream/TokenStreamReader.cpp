@@ -0,0 +1,119 @@
+#include "TokenStreamReader.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "TokenStreamFormat.h"
+
+TokenStreamReader::TokenStreamReader(const std::string& file_name) :
+      file_(file_name) {
+  if (!file_.IsOpen()) {
+    throw std::runtime_error(
+        "exception thrown: unable to open token file " + file_name);
+  }
+  TokenStreamHeader header;
+  if (file_.Size() < sizeof(header)) {
+    throw std::runtime_error(
+        "exception thrown: " + file_name + " is not a token file");
+  }
+  std::memcpy(&header, file_.Begin(), sizeof(header));
+  if (std::memcmp(header.magic, TokenStreamHeader::kMagic,
+                  sizeof(header.magic)) != 0) {
+    throw std::runtime_error(
+        "exception thrown: " + file_name + " is not a token file");
+  }
+  if (header.version != TokenStreamHeader::kVersion) {
+    throw std::runtime_error(
+        "exception thrown: unsupported token file version " +
+        std::to_string(header.version) + " in " + file_name);
+  }
+  token_count_ = header.token_count;
+  string_count_ = header.string_count;
+
+  #pragma region SECTIONS
+  size_t position = sizeof(header);
+  auto section = [&position](size_t size) {
+    size_t begin = position;
+    position += AlignTokenStreamSection(size);
+    return begin;
+  };
+  size_t kinds = section(token_count_);
+  size_t offsets = section(token_count_ * sizeof(uint32_t));
+  size_t strings = section(token_count_ * sizeof(uint32_t));
+  size_t values = section(string_count_ * sizeof(uint64_t));
+  size_t bounds = section((string_count_ + size_t{1}) * sizeof(uint32_t));
+  size_t pool = section(header.pool_size);
+  if (position > file_.Size()) {
+    throw std::runtime_error(
+        "exception thrown: token file " + file_name + " is truncated");
+  }
+  kinds_ = reinterpret_cast<const uint8_t*>(file_.Begin() + kinds);
+  offsets_ = reinterpret_cast<const uint32_t*>(file_.Begin() + offsets);
+  strings_ = reinterpret_cast<const uint32_t*>(file_.Begin() + strings);
+  values_ = reinterpret_cast<const uint64_t*>(file_.Begin() + values);
+  bounds_ = reinterpret_cast<const uint32_t*>(file_.Begin() + bounds);
+  pool_ = file_.Begin() + pool;
+  #pragma endregion SECTIONS
+
+  // The only checks that look past the header: every kind has to name a
+  // type and a value type, and every pool string has to lie inside the
+  // pool.
+  for (uint32_t i = 0; i < token_count_; ++i) {
+    if ((kinds_[i] & 0x0F) > static_cast<uint8_t>(Token::Type::ERROR) ||
+        (kinds_[i] >> 4) > static_cast<uint8_t>(Token::ValueType::REAL)) {
+      throw std::runtime_error(
+          "exception thrown: token file " + file_name + " is corrupted");
+    }
+  }
+  if (bounds_[0] != 0 || bounds_[string_count_] != header.pool_size) {
+    throw std::runtime_error(
+        "exception thrown: token file " + file_name + " is corrupted");
+  }
+  for (uint32_t i = 0; i < string_count_; ++i) {
+    if (bounds_[i] > bounds_[i + 1]) {
+      throw std::runtime_error(
+          "exception thrown: token file " + file_name + " is corrupted");
+    }
+  }
+}
+
+size_t TokenStreamReader::Size() const { return token_count_; }
+
+Token::Type TokenStreamReader::GetType(size_t index) const {
+  return static_cast<Token::Type>(kinds_[index] & 0x0F);
+}
+
+uint32_t TokenStreamReader::GetOffset(size_t index) const {
+  return offsets_[index];
+}
+
+std::string_view TokenStreamReader::GetSymbol(size_t index) const {
+  uint32_t string = GetString(index);
+  return std::string_view(pool_ + bounds_[string],
+                          bounds_[string + 1] - bounds_[string]);
+}
+
+Token TokenStreamReader::GetToken(size_t index) const {
+  uint32_t string = GetString(index);
+  Token token;
+  token.symbol = std::string_view(pool_ + bounds_[string],
+                                  bounds_[string + 1] - bounds_[string]);
+  token.type = GetType(index);
+  token.value_type = static_cast<Token::ValueType>(kinds_[index] >> 4);
+  token.offset = offsets_[index];
+  if (token.type == Token::Type::IDENTIFIER) token.symbol_id = string;
+  if (token.value_type != Token::ValueType::NONE) {
+    std::memcpy(&token.value, &values_[string], sizeof(uint64_t));
+  }
+  return token;
+}
+
+uint32_t TokenStreamReader::GetString(size_t index) const {
+  uint32_t string = strings_[index];
+  if (string >= string_count_) {
+    throw std::runtime_error(
+        "exception thrown: token file is corrupted, string " +
+        std::to_string(string) + " is not in the pool");
+  }
+  return string;
+}
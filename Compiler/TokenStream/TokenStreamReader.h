@@ -0,0 +1,41 @@
+#ifndef TOKENSTREAMREADER
+#define TOKENSTREAMREADER
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "SourceBuffer.h"
+#include "Token.h"
+
+// Maps a file written by TokenStreamWriter and reads tokens straight from
+// its sections, nothing is decoded up front. Symbols point into the
+// mapping, so tokens must not outlive the reader. symbol_id of an
+// IDENTIFIER is its index in the file's string pool, not an interner id.
+class TokenStreamReader {
+ public:
+  // Throws when the file can not be opened, is not a token file of a
+  // supported version or has token kinds or pool bounds out of range.
+  explicit TokenStreamReader(const std::string& file_name);
+
+  size_t Size() const;
+  Token::Type GetType(size_t index) const;
+  uint32_t GetOffset(size_t index) const;
+  std::string_view GetSymbol(size_t index) const;
+  Token GetToken(size_t index) const;
+
+ private:
+  uint32_t GetString(size_t index) const;
+
+  SourceBuffer file_;
+  uint32_t token_count_;
+  uint32_t string_count_;
+  const uint8_t* kinds_;
+  const uint32_t* offsets_;
+  const uint32_t* strings_;
+  const uint64_t* values_;
+  const uint32_t* bounds_;
+  const char* pool_;
+};
+
+#endif
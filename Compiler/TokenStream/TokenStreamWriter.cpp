@@ -0,0 +1,69 @@
+#include "TokenStreamWriter.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "TokenStreamFormat.h"
+
+namespace {
+
+template <typename T>
+void WriteSection(const T* data, size_t count, std::ostream& output) {
+  static const char kPadding[8] = {};
+  size_t size = count * sizeof(T);
+  output.write(reinterpret_cast<const char*>(data), size);
+  output.write(kPadding, AlignTokenStreamSection(size) - size);
+}
+
+}  // namespace
+
+void TokenStreamWriter::Add(const Token& token) {
+  auto string = string_ids_.find(token.symbol);
+  if (string == string_ids_.end()) {
+    if (pool_.size() + token.symbol.size() > UINT32_MAX) {
+      throw std::runtime_error(
+          "exception thrown: token file string pool exceeds 4 GiB");
+    }
+    pool_.append(token.symbol);
+    bounds_.push_back(static_cast<uint32_t>(pool_.size()));
+    values_.push_back(0);
+    string = string_ids_.emplace(
+        token.symbol, static_cast<uint32_t>(values_.size() - 1)).first;
+  }
+  kinds_.push_back(static_cast<uint8_t>(token.type) |
+                   static_cast<uint8_t>(token.value_type) << 4);
+  offsets_.push_back(token.offset);
+  strings_.push_back(string->second);
+  if (token.value_type != Token::ValueType::NONE) {
+    // The text decides the value, so equal numbers share it.
+    std::memcpy(&values_[string->second], &token.value, sizeof(uint64_t));
+  }
+}
+
+void TokenStreamWriter::Write(std::ostream& output) const {
+  TokenStreamHeader header = {};
+  std::memcpy(header.magic, TokenStreamHeader::kMagic, sizeof(header.magic));
+  header.version = TokenStreamHeader::kVersion;
+  header.token_count = static_cast<uint32_t>(kinds_.size());
+  header.string_count = static_cast<uint32_t>(values_.size());
+  header.pool_size = static_cast<uint32_t>(pool_.size());
+  output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  WriteSection(kinds_.data(), kinds_.size(), output);
+  WriteSection(offsets_.data(), offsets_.size(), output);
+  WriteSection(strings_.data(), strings_.size(), output);
+  WriteSection(values_.data(), values_.size(), output);
+  WriteSection(bounds_.data(), bounds_.size(), output);
+  WriteSection(pool_.data(), pool_.size(), output);
+}
+
+void TokenStreamWriter::Clear() {
+  kinds_.clear();
+  offsets_.clear();
+  strings_.clear();
+  values_.clear();
+  bounds_.assign(1, 0);
+  pool_.clear();
+  string_ids_.clear();
+}
+
+size_t TokenStreamWriter::Size() const { return kinds_.size(); }
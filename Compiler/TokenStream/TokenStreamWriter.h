@@ -0,0 +1,34 @@
+#ifndef TOKENSTREAMWRITER
+#define TOKENSTREAMWRITER
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Token.h"
+
+// Collects tokens column by column and writes them as one binary token
+// file (see TokenStreamFormat.h), one write per section. Symbols are
+// deduplicated by their text, which is looked up through the added tokens,
+// so those must stay valid until the writer is cleared or destroyed.
+class TokenStreamWriter {
+ public:
+  void Add(const Token& token);
+  void Write(std::ostream& output) const;
+  void Clear();
+  size_t Size() const;
+
+ private:
+  std::vector<uint8_t> kinds_;
+  std::vector<uint32_t> offsets_;
+  std::vector<uint32_t> strings_;
+  std::vector<uint64_t> values_;
+  std::vector<uint32_t> bounds_ = {0};
+  std::string pool_;
+  std::unordered_map<std::string_view, uint32_t> string_ids_;
+};
+
+#endif
@@ -1,42 +1,346 @@
 #include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <new>
 #include <string>
+#include <vector>
 
+#include "BatchLexer.h"
+#include "HardwareCounters.h"
 #include "LexicAnalyzer.h"
+#include "LexerStats.h"
+#include "LexerVocabulary.h"
+#include "ParallelLexer.h"
+#include "Parser.h"
+#include "SourceBuffer.h"
 #include "Token.h"
+#include "TokenCache.h"
+#include "TokenStreamWriter.h"
 
+#ifdef LEXER_STATS
+namespace {
+
+std::atomic<uint64_t> allocation_count{0};
+
+void* Allocate(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* memory = std::malloc(size != 0 ? size : 1)) return memory;
+  throw std::bad_alloc();
+}
+
+}  // namespace
+
+// Counted for the phases of --stats.
+void* operator new(size_t size) { return Allocate(size); }
+void* operator new[](size_t size) { return Allocate(size); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+#endif
+
+namespace {
+
+// Times consecutive phases of the CLI for --stats, and counts their
+// hardware events for --profile.
+class PhaseTimer {
+ public:
+  explicit PhaseTimer(bool is_profiled) {
+    if (is_profiled) counters_ = std::make_unique<HardwareCounters>();
+    Start();
+  }
+
+  void Start() {
+    start_ = std::chrono::steady_clock::now();
+    start_allocations_ = GetAllocationCount();
+    if (counters_) start_counters_ = counters_->Read();
+  }
+
+  // Ends the phase begun by the last Start() or End() and begins the next.
+  // bytes and tokens are what the phase went through, if it is about them.
+  void End(const char* name, uint64_t bytes = 0, uint64_t tokens = 0) {
+    HardwareCounters::Sample counters;
+    if (counters_) counters = counters_->Read() - start_counters_;
+    std::chrono::duration<double> duration =
+        std::chrono::steady_clock::now() - start_;
+    phases_.push_back(LexerStats::Phase{
+        name, duration.count(), GetAllocationCount() - start_allocations_,
+        counters, bytes, tokens});
+    Start();
+  }
+
+  // Null unless profiling.
+  const HardwareCounters* GetCounters() const { return counters_.get(); }
+
+  // The phases ended so far, with the counters of stats.
+  void Write(LexerStats stats, bool is_json, std::ostream& output) const {
+    for (const LexerStats::Phase& phase : phases_) stats.AddPhase(phase);
+    if (counters_) stats.SetProfile(*counters_);
+    if (is_json) {
+      stats.WriteJson(output);
+    } else {
+      stats.WriteText(output);
+    }
+  }
+
+ private:
+  static uint64_t GetAllocationCount() {
+#ifdef LEXER_STATS
+    return allocation_count.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+  }
+
+  std::chrono::steady_clock::time_point start_;
+  uint64_t start_allocations_;
+  std::unique_ptr<HardwareCounters> counters_;
+  HardwareCounters::Sample start_counters_;
+  std::vector<LexerStats::Phase> phases_;
+};
+
+}  // namespace
 
 int main(int argc, const char* argv[]) {
   #ifdef _DEBUG
   argc = 2;
   argv[1] = "debug.txt";
   #endif
-  if (argc < 2) {
+  std::vector<std::string> input_files;
+  bool is_batch = false;
+  bool is_parallel = false;
+  bool is_ast = false;
+  bool is_stats = false;
+  bool is_stats_json = false;
+  bool is_profiled = false;
+  bool is_state_profiled = false;
+  size_t thread_count = 0;
+  size_t chunk_size = ParallelLexer::kDefaultChunkSize;
+  size_t max_errors = 0;
+  std::string lists_directory;
+  std::string cache_directory;
+  uint64_t cache_size = TokenCache::kDefaultMaxSize;
+  LexicAnalyzer::Engine engine = LexicAnalyzer::Engine::STATE_MACHINE;
+  BatchLexer::OutputFormat format = BatchLexer::OutputFormat::TEXT;
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (argument == "--engine=table") {
+      engine = LexicAnalyzer::Engine::TABLE;
+    } else if (argument == "--engine=states") {
+      engine = LexicAnalyzer::Engine::STATE_MACHINE;
+    } else if (argument == "--format=binary") {
+      format = BatchLexer::OutputFormat::BINARY;
+    } else if (argument == "--format=text") {
+      format = BatchLexer::OutputFormat::TEXT;
+    } else if (argument.rfind("--lists=", 0) == 0) {
+      lists_directory = argument.substr(8);
+    } else if (argument.rfind("--cache-dir=", 0) == 0) {
+      // Reuse the tokens of files lexed before with the same lists.
+      cache_directory = argument.substr(12);
+    } else if (argument.rfind("--cache-size=", 0) == 0) {
+      // In MiB.
+      cache_size = std::stoull(argument.substr(13)) << 20;
+    } else if (argument == "--ast") {
+      // Parse and write the syntax tree instead of the tokens.
+      is_ast = true;
+    } else if (argument == "--stats" || argument == "--stats=json") {
+      // Report where the time went; counters need a LEXER_STATS build.
+      is_stats = true;
+      is_stats_json = argument == "--stats=json";
+    } else if (argument == "--profile" || argument == "--profile=states") {
+      // --stats with hardware counters, per state too in LEXER_STATS builds.
+      is_stats = true;
+      is_profiled = true;
+      is_state_profiled = argument == "--profile=states";
+    } else if (argument == "--parallel") {
+      is_parallel = true;
+    } else if (argument.rfind("--chunk-size=", 0) == 0) {
+      chunk_size = std::stoul(argument.substr(13));
+    } else if (argument.rfind("--max-errors=", 0) == 0) {
+      // Report up to N errors per file instead of stopping at the first.
+      max_errors = std::stoul(argument.substr(13));
+    } else if (argument.rfind("--jobs=", 0) == 0) {
+      thread_count = std::stoul(argument.substr(7));
+    } else if (argument[0] == '@') {
+      // Response file with one input path per line.
+      is_batch = true;
+      try {
+        for (std::string& file : 
+             BatchLexer::ReadResponseFile(argument.substr(1))) {
+          input_files.push_back(std::move(file));
+        }
+      } catch (const std::runtime_error& e) {
+        std::cout << e.what() << "\n";
+        std::cin.get();
+        return -1;
+      }
+    } else {
+      input_files.push_back(argument);
+    }
+  }
+  if (input_files.empty()) {
     std::cout << "Analyzed file is not defined!\n";
     std::cin.get();
     return -1;
   }
+  if (input_files.size() > 1) is_batch = true;
+  if (is_parallel && max_errors != 0) {
+    std::cout << "--max-errors can not be combined with --parallel\n";
+    std::cin.get();
+    return -1;
+  }
+  if (is_ast && (is_batch || is_parallel || !cache_directory.empty())) {
+    std::cout << "--ast only parses a single file, without --parallel or "
+                 "--cache-dir\n";
+    std::cin.get();
+    return -1;
+  }
+  if (is_stats && (is_batch || is_parallel || !cache_directory.empty())) {
+    std::cout << "--stats and --profile only report on a single file, "
+                 "without --parallel or --cache-dir\n";
+    std::cin.get();
+    return -1;
+  }
 
-  std::wstring token_type[] = {
-        L"RESERVED", 
-        L"IDENTIFIER", 
-        L"NUMERIC_CONSTANT", 
-        L"LITERAL_CONSTANT", 
-        L"OPERATOR", 
-        L"PUNCTUATION"
+  // Without --lists the compiled-in vocabulary is used, so the working
+  // directory does not matter.
+  PhaseTimer timer(is_profiled);
+  std::shared_ptr<const LexerVocabulary> vocabulary =
+      LexerVocabulary::Default();
+  if (!lists_directory.empty()) {
+    try {
+      vocabulary = std::make_shared<const LexerVocabulary>(lists_directory);
+    } catch (const std::runtime_error& e) {
+      std::cout << "Error accured during initialization of lexic analyzer\n";
+      std::cout << e.what() << "\n";
+      std::cin.get();
+      return -1;
+    }
+  }
+  timer.End("vocabulary");
+
+  std::shared_ptr<TokenCache> cache;
+  if (!cache_directory.empty()) {
+    try {
+      cache = std::make_shared<TokenCache>(cache_directory, *vocabulary,
+                                           cache_size);
+    } catch (const std::runtime_error& e) {
+      std::cout << e.what() << "\n";
+      std::cin.get();
+      return -1;
+    }
+  }
+  auto print_cache_stats = [&cache] {
+    if (!cache) return;
+    TokenCache::Stats stats = cache->GetStats();
+    std::cout << "token cache: " << stats.hits << " hits, " << stats.misses
+              << " misses, " << stats.evictions << " evicted, "
+              << stats.entries << " entries, " << stats.size << " bytes\n";
   };
 
-  std::wifstream file_input(argv[1]);
-  if (!file_input.is_open()) {
+  if (is_batch) {
+    BatchLexer batch(vocabulary, engine, thread_count);
+    batch.SetMaxErrors(max_errors);
+    batch.SetOutputFormat(format);
+    batch.SetCache(cache);
+    int failed = 0;
+    for (const BatchLexer::Result& result : batch.Run(input_files)) {
+      if (result.error.empty()) continue;
+      std::cout << result.input_file << ": " << result.error << "\n";
+      ++failed;
+    }
+    print_cache_stats();
+    if (failed != 0) {
+      std::cout << failed << " of " << input_files.size()
+                << " files failed\n";
+      std::cin.get();
+      return -1;
+    }
+    return 0;
+  }
+  const char* input_file_name = input_files.front().c_str();
+  const char* output_file_name = "output_tokens.txt";
+  std::ios::openmode output_mode = std::ios::out;
+  if (format == BatchLexer::OutputFormat::BINARY) {
+    output_file_name = "output_tokens.bin";
+    output_mode |= std::ios::binary;
+  }
+
+  if (cache && !is_parallel) {
+    BatchLexer lexer(vocabulary, engine, 1);
+    lexer.SetMaxErrors(max_errors);
+    lexer.SetOutputFormat(format);
+    lexer.SetCache(cache);
+    BatchLexer::Result result = lexer.LexFile(input_file_name,
+                                              output_file_name);
+    print_cache_stats();
+    if (!result.error.empty()) {
+      std::cout << result.error << "\n";
+      std::cin.get();
+      return -1;
+    }
+    return 0;
+  }
+
+  timer.Start();
+  SourceBuffer source(input_file_name);
+  if (!source.IsOpen()) {
     std::cout << "Unable to open analyzed file\n";
     std::cin.get();
     return -1;
   }
 
+  if (is_parallel) {
+    ParallelLexer parallel_lexer(vocabulary, engine, thread_count,
+                                 chunk_size);
+    std::ofstream file_output(output_file_name, output_mode);
+    if (!file_output.is_open()) {
+      std::cout << "Unable to open output stream\n";
+      std::cin.get();
+    }
+    uint64_t key = 0;
+    if (cache) {
+      key = cache->GetKey(source, engine);
+      if (std::unique_ptr<TokenStreamReader> cached = cache->Find(key)) {
+        std::vector<Token> tokens(cached->Size());
+        for (size_t i = 0; i < tokens.size(); ++i) {
+          tokens[i] = cached->GetToken(i);
+        }
+        BatchLexer::WriteTokens(tokens, file_output, format);
+        print_cache_stats();
+        return 0;
+      }
+    }
+    try {
+      parallel_lexer.Lex(source);
+    } catch (const std::runtime_error& e) {
+      BatchLexer::WriteTokens(parallel_lexer.GetTokens(), file_output,
+                              format);
+      std::cout << "Error accured during lexing\n";
+      std::cout << e.what() << "\n";
+      std::cin.get();
+      return -1;
+    }
+    BatchLexer::WriteTokens(parallel_lexer.GetTokens(), file_output,
+                            format);
+    if (cache) {
+      TokenStreamWriter writer;
+      for (const Token& token : parallel_lexer.GetTokens()) writer.Add(token);
+      cache->Store(key, writer);
+      print_cache_stats();
+    }
+    return 0;
+  }
+
+  timer.End("input");
+  size_t source_size = source.Size();
   LexicAnalyzer* analyzer;
   try {
-    analyzer = new LexicAnalyzer(file_input);
+    analyzer = new LexicAnalyzer(std::move(source), vocabulary, engine);
   } catch (const std::runtime_error& e) {
     std::cout << "Error accured during initialization of lexic analyzer\n";
     std::cout << e.what() << "\n";
@@ -44,7 +348,38 @@ int main(int argc, const char* argv[]) {
     return -1;
   }
 
-  std::string file_name = argv[1];
+  analyzer->SetMaxErrors(max_errors);
+  if (is_state_profiled) analyzer->SetProfiler(timer.GetCounters());
+  if (is_ast) {
+    std::ofstream ast_output("output_ast.txt");
+    if (!ast_output.is_open()) {
+      std::cout << "Unable to open output stream\n";
+      std::cin.get();
+    }
+    try {
+      Parser parser(*analyzer);
+      timer.End("lexing", source_size);
+      Ast ast = parser.Parse();
+      timer.End("parsing", 0, ast.GetTokens().Size());
+      ast.Dump(ast_output);
+      ast_output.close();
+      timer.End("output");
+    } catch (const std::runtime_error& e) {
+      for (const Diagnostic& diagnostic : analyzer->GetDiagnostics()) {
+        std::cout << analyzer->FormatDiagnostic(diagnostic) << "\n";
+      }
+      std::cout << "Error accured during parsing\n";
+      std::cout << e.what() << "\n";
+      delete analyzer;
+      std::cin.get();
+      return -1;
+    }
+    if (is_stats) timer.Write(analyzer->GetStats(), is_stats_json, std::cout);
+    delete analyzer;
+    return 0;
+  }
+
+  std::string file_name = input_file_name;
   auto file_name_offset = file_name.find_last_of('\\');
   if (file_name_offset == std::string::npos) file_name_offset = 0;
   auto file_name_extension_offset = file_name.find_first_of('.',
@@ -53,32 +388,44 @@ int main(int argc, const char* argv[]) {
   file_name = file_name.substr(file_name_offset,
                                file_name_offset - file_name_extension_offset);
 
-  std::queue<Token> tokens;
+  std::ofstream file_output(output_file_name, output_mode);
+  if (!file_output.is_open()) {
+    std::cout << "Unable to open output stream\n";
+    std::cin.get();
+  }
+
+  // Timing lexing apart from output takes all tokens before writing any.
+  std::vector<Token> tokens;
   try {
-    tokens = analyzer->GetTokens(); 
+    if (is_stats) {
+      for (const Token& token : analyzer->Tokens()) tokens.push_back(token);
+    } else {
+      BatchLexer::WriteTokens(*analyzer, file_output, format);
+    }
   } catch (const std::runtime_error& e) {
+    if (is_stats) BatchLexer::WriteTokens(tokens, file_output, format);
     std::cout << "Error accured during lexing\n";
     std::cout << e.what() << "\n";
     std::cin.get();
     return -1;
   }
-  file_input.close();
-
-  std::wfstream file_output("output_tokens.txt", std::ios::out);
-  if (!file_output.is_open()) {
-    std::cout << "Unable to open output stream\n";
-    std::cin.get();
-  }
-
-  while (!tokens.empty()) {
-    Token cur_token = tokens.front();
-    std::wstring line;
-    line += token_type[static_cast<int>(cur_token.type)] +
-            L" " + cur_token.symbol + L"\n";
-    file_output << line;
-    tokens.pop();
+  if (is_stats) {
+    timer.End("lexing", source_size, tokens.size());
+    BatchLexer::WriteTokens(tokens, file_output, format);
   }
   file_output.close();
+  if (is_stats) {
+    timer.End("output");
+    timer.Write(analyzer->GetStats(), is_stats_json, std::cout);
+  }
+  bool has_errors = !analyzer->GetDiagnostics().empty();
+  for (const Diagnostic& diagnostic : analyzer->GetDiagnostics()) {
+    std::cout << analyzer->FormatDiagnostic(diagnostic) << "\n";
+  }
   delete analyzer;
+  if (has_errors) {
+    std::cin.get();
+    return -1;
+  }
   return 0;
 }
\ No newline at end of file
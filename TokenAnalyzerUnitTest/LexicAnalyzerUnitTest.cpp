@@ -1,7 +1,7 @@
 #include "pch.h"
+#include <chrono>
 #include <filesystem>
 #include <fstream>
-#include <queue>
 #include <sstream>
 #include <string>
 #include <algorithm>
@@ -9,7 +9,58 @@
 
 #include "..\Compiler\LexicAnalyzer.cpp"
 #include "..\Compiler\LexicAnalyzer.h"
+#include "..\Compiler\LexicAnalyzer\SourceBuffer.cpp"
+#include "..\Compiler\LexicAnalyzer\SourceBuffer.h"
+#include "..\Compiler\LexicAnalyzer\TokenIterator.cpp"
+#include "..\Compiler\LexicAnalyzer\TokenIterator.h"
+#include "..\Compiler\LexicAnalyzer\TableLexer.cpp"
+#include "..\Compiler\LexicAnalyzer\TableLexer.h"
+#include "..\Compiler\LexicAnalyzer\StaticVocabulary.cpp"
+#include "..\Compiler\LexicAnalyzer\StaticVocabulary.h"
+#include "..\Compiler\LexicAnalyzer\Scanner.cpp"
+#include "..\Compiler\LexicAnalyzer\Scanner.h"
+#include "..\Compiler\LexicAnalyzer\LexerVocabulary.cpp"
+#include "..\Compiler\LexicAnalyzer\LexerVocabulary.h"
+#include "..\Compiler\LexicAnalyzer\NumberParser.cpp"
+#include "..\Compiler\LexicAnalyzer\NumberParser.h"
+#include "..\Compiler\LexicAnalyzer\StringInterner.cpp"
+#include "..\Compiler\LexicAnalyzer\StringInterner.h"
+#include "..\Compiler\LexicAnalyzer\LineIndex.cpp"
+#include "..\Compiler\LexicAnalyzer\LineIndex.h"
+#include "..\Compiler\LexicAnalyzer\Hash.h"
+#include "..\Compiler\LexicAnalyzer\Arena.cpp"
+#include "..\Compiler\LexicAnalyzer\Arena.h"
+#include "..\Compiler\LexicAnalyzer\GapBuffer.h"
+#include "..\Compiler\LexicAnalyzer\IncrementalLexer.cpp"
+#include "..\Compiler\LexicAnalyzer\IncrementalLexer.h"
+#include "..\Compiler\LexicAnalyzer\TokenBuffer.cpp"
+#include "..\Compiler\LexicAnalyzer\TokenBuffer.h"
+#include "..\Compiler\LexicAnalyzer\UnicodeClasses.cpp"
+#include "..\Compiler\LexicAnalyzer\UnicodeClasses.h"
+#include "..\Compiler\LexicAnalyzer\Utf8.h"
+#include "..\Compiler\LexicAnalyzer\HardwareCounters.cpp"
+#include "..\Compiler\LexicAnalyzer\HardwareCounters.h"
+#include "..\Compiler\LexicAnalyzer\LexerStats.cpp"
+#include "..\Compiler\LexicAnalyzer\LexerStats.h"
+#include "..\Compiler\Parser\Ast.cpp"
+#include "..\Compiler\Parser\Ast.h"
+#include "..\Compiler\Parser\Parser.cpp"
+#include "..\Compiler\Parser\Parser.h"
+#include "..\Compiler\Batch\ThreadPool.cpp"
+#include "..\Compiler\Batch\ThreadPool.h"
+#include "..\Compiler\Batch\BatchLexer.cpp"
+#include "..\Compiler\Batch\BatchLexer.h"
+#include "..\Compiler\Batch\ParallelLexer.cpp"
+#include "..\Compiler\Batch\ParallelLexer.h"
+#include "..\Compiler\TokenStream\TokenStreamWriter.cpp"
+#include "..\Compiler\TokenStream\TokenStreamWriter.h"
+#include "..\Compiler\TokenStream\TokenStreamReader.cpp"
+#include "..\Compiler\TokenStream\TokenStreamReader.h"
+#include "..\Compiler\TokenStream\TokenStreamFormat.h"
+#include "..\Compiler\TokenStream\TokenCache.cpp"
+#include "..\Compiler\TokenStream\TokenCache.h"
 #include "..\Compiler\Token.h"
+#include "..\Compiler\Diagnostic.h"
 #include "..\Compiler\OperatorState.cpp"
 #include "..\Compiler\BeginState.cpp"
 #include "..\Compiler\IDState.cpp"
@@ -26,45 +77,82 @@ TEST_CLASS(LexicAnalyzerUnitTest) {
   const std::wstring tests_directory = L"lexic_analyzer_tests_";
   const std::wstring project_name = L"Compiler";
 
-  std::map<Token::Type, std::wstring> token_names {
-      { Token::Type::RESERVED, L"RESERVED" },
-      { Token::Type::IDENTIFIER, L"IDENTIFIER" }, 
-      { Token::Type::NUMCONSTANT, L"NUMERIC_CONSTANT"},
-      { Token::Type::OPERATOR, L"OPERATOR" },
-      { Token::Type::PUNCTUATION, L"PUNCTUATION" },
-      { Token::Type::LITCONSTANT, L"LITERAL_CONSTANT" }
+  std::map<Token::Type, std::string> token_names {
+      { Token::Type::RESERVED, "RESERVED" },
+      { Token::Type::IDENTIFIER, "IDENTIFIER" }, 
+      { Token::Type::NUMCONSTANT, "NUMERIC_CONSTANT"},
+      { Token::Type::OPERATOR, "OPERATOR" },
+      { Token::Type::PUNCTUATION, "PUNCTUATION" },
+      { Token::Type::LITCONSTANT, "LITERAL_CONSTANT" },
+      { Token::Type::ERROR, "ERROR" }
   };
 
-  void RunTest(std::wstring input_filename, std::wstring expected_filename) {
+  std::wstring GetTestsPath() {
       std::wstring cur_path = std::filesystem::current_path().wstring();
       size_t project_name_offset = cur_path.find(project_name);
       size_t first_backslash = cur_path.find(L'\\', project_name_offset);
-      cur_path = cur_path.substr(0, first_backslash + 1) + 
-                 tests_directory + L"\\";
+      return cur_path.substr(0, first_backslash + 1) + 
+             tests_directory + L"\\";
+  }
+
+  void RunTest(std::wstring input_filename, std::wstring expected_filename) {
+      std::wstring cur_path = GetTestsPath();
 
       std::wifstream file_input(cur_path + input_filename);
-      std::wifstream file_expected(cur_path + expected_filename);
+      std::ifstream file_expected(cur_path + expected_filename);
 
       LexicAnalyzer analyzer(file_input);
       
-      std::queue<Token> actual_tokens;
-      actual_tokens = analyzer.GetTokens(); 
+      TokenBuffer actual_tokens = analyzer.GetTokens();
 
       Assert::IsTrue(file_input.is_open() && file_expected.is_open(),
                      L"UNABLE TO OPEN INPUT OR/AND EXPECTED FILE(S)"
                      L"\nCHECK IF THEY ARE IN TESTS DIRECTORY");
 
-      std::wstring line;
+      CompareTokens(actual_tokens, file_expected);
+
+      SourceBuffer mapped_input(
+          std::filesystem::path(cur_path + input_filename).string());
+      Assert::IsTrue(mapped_input.IsOpen(), L"UNABLE TO MAP INPUT FILE");
+      LexicAnalyzer mapped_analyzer(std::move(mapped_input));
+      file_expected.clear();
+      file_expected.seekg(0);
+      CompareTokens(mapped_analyzer.GetTokens(), file_expected);
+
+      std::wifstream streamed_input(cur_path + input_filename);
+      LexicAnalyzer streamed_analyzer(streamed_input);
+      TokenBuffer streamed_tokens;
+      for (const Token& token : streamed_analyzer.Tokens()) {
+        streamed_tokens.Push(token);
+      }
+      file_expected.clear();
+      file_expected.seekg(0);
+      CompareTokens(streamed_tokens, file_expected);
+
+      SourceBuffer table_input(
+          std::filesystem::path(cur_path + input_filename).string());
+      LexicAnalyzer table_analyzer(std::move(table_input),
+                                   LexicAnalyzer::Engine::TABLE);
+      file_expected.clear();
+      file_expected.seekg(0);
+      CompareTokens(table_analyzer.GetTokens(), file_expected);
+  }
+
+  void CompareTokens(const TokenBuffer& actual_tokens,
+                     std::ifstream& file_expected) {
+      std::string line;
+      size_t index = 0;
       while (std::getline(file_expected, line)) {
-          Assert::IsTrue(!actual_tokens.empty(), L"QUEUE IS EMPTY");
+          Assert::IsTrue(index < actual_tokens.Size(), L"BUFFER IS EMPTY");
 
-          Token actual_token = actual_tokens.front();
-          Assert::IsTrue(line.compare(token_names[actual_token.type] + L" " 
-                         + actual_token.symbol) == 0, L"TOKENS DO NOT MATCH");
-          actual_tokens.pop();
+          Token actual_token = actual_tokens[index];
+          Assert::IsTrue(line.compare(token_names[actual_token.type] + " " 
+                         + std::string(actual_token.symbol)) == 0,
+                         L"TOKENS DO NOT MATCH");
+          ++index;
       }
-      Assert::IsTrue(actual_tokens.empty(),
-                     L"QUEUE IS NOT EMPTY AFTER TESTING");
+      Assert::IsTrue(index == actual_tokens.Size(),
+                     L"BUFFER IS NOT EMPTY AFTER TESTING");
   }
 
   void RunExceptionTest(std::wstring input_filename) {
@@ -75,6 +163,1075 @@ TEST_CLASS(LexicAnalyzerUnitTest) {
       caught = true;
     }
     Assert::IsTrue(caught);
+
+    caught = false;
+    SourceBuffer table_input(
+        std::filesystem::path(GetTestsPath() + input_filename).string());
+    LexicAnalyzer table_analyzer(std::move(table_input),
+                                 LexicAnalyzer::Engine::TABLE);
+    try {
+      table_analyzer.GetTokens();
+    } catch (std::runtime_error& e) {
+      caught = true;
+    }
+    Assert::IsTrue(caught, L"TABLE ENGINE DID NOT THROW");
+  }
+
+  std::string ParseToText(const std::string& source) {
+    LexicAnalyzer analyzer{SourceBuffer(source.data(), source.size())};
+    Parser parser(analyzer);
+    std::ostringstream dump;
+    parser.Parse().Dump(dump);
+    return dump.str();
+  }
+
+  std::string ParseError(const std::string& source) {
+    try {
+      ParseToText(source);
+    } catch (std::runtime_error& e) {
+      return e.what();
+    }
+    return "";
+  }
+
+  TEST_METHOD(Streaming_TokensBeforeError) {
+    const char source[] = "var a;\n\"unterminated\n";
+    LexicAnalyzer analyzer{SourceBuffer(source, sizeof(source) - 1)};
+    Token token;
+    Assert::IsTrue(analyzer.NextToken(token) && token.symbol == "var");
+    Assert::IsTrue(analyzer.NextToken(token) && token.symbol == "a");
+    Assert::IsTrue(analyzer.NextToken(token) && token.symbol == ";");
+    bool caught = false;
+    try {
+      analyzer.NextToken(token);
+    } catch (std::runtime_error& e) {
+      caught = true;
+    }
+    Assert::IsTrue(caught);
+  }
+
+  TEST_METHOD(StaticVocabulary_Lookup) {
+    for (std::string_view word : StaticVocabulary::kReserved) {
+      Assert::IsTrue(StaticVocabulary::IsReserved(word));
+    }
+    for (std::string_view word : StaticVocabulary::kOperators) {
+      Assert::IsTrue(StaticVocabulary::IsOperator(word));
+    }
+    Assert::IsFalse(StaticVocabulary::IsReserved("whil"));
+    Assert::IsFalse(StaticVocabulary::IsReserved("whiles"));
+    Assert::IsFalse(StaticVocabulary::IsReserved(""));
+    Assert::IsFalse(StaticVocabulary::IsOperator("<<<"));
+    Assert::IsFalse(StaticVocabulary::IsOperator("if"));
+    Assert::IsTrue(StaticVocabulary::IsPunctuation(U';'));
+    Assert::IsFalse(StaticVocabulary::IsPunctuation(U'+'));
+    Assert::IsFalse(StaticVocabulary::IsPunctuation(U'\u037E'));
+  }
+
+  TEST_METHOD(Scanner_AllLevels) {
+    const Scanner::Level initial_level = Scanner::GetLevel();
+    const Scanner::Level levels[] = {Scanner::Level::SCALAR,
+                                      Scanner::Level::SSE2,
+                                      Scanner::Level::AVX2};
+    for (Scanner::Level level : levels) {
+      Scanner::SetLevel(level);
+      // Runs ending at every offset, so vector bodies and scalar tails
+      // both find the stop byte.
+      for (size_t length = 0; length < 70; ++length) {
+        std::string blanks = std::string(length, ' ') + "\t\r\nx";
+        const char* begin = blanks.data();
+        const char* end = begin + blanks.size();
+        Assert::IsTrue(Scanner::SkipBlanks(begin, end) == end - 1);
+
+        std::string identifier = std::string(length, 'a') + "Z_09\xC3\xA9";
+        begin = identifier.data();
+        end = begin + identifier.size();
+        Assert::IsTrue(Scanner::SkipIdentifier(begin, end) == end - 2);
+
+        std::string digits = std::string(length, '7') + ".5";
+        begin = digits.data();
+        end = begin + digits.size();
+        Assert::IsTrue(Scanner::SkipDigits(begin, end) == begin + length);
+
+        std::string comment = std::string(length, '#') + "\n";
+        begin = comment.data();
+        end = begin + comment.size();
+        Assert::IsTrue(Scanner::FindNewline(begin, end) == end - 1);
+        Assert::IsTrue(Scanner::FindNewline(begin, end - 1) == end - 1);
+
+        std::string text = std::string(length, 's') + "\xC3\xA9'\"\\\n";
+        begin = text.data();
+        end = begin + text.size();
+        Assert::IsTrue(Scanner::SkipStringText(begin, end) == end - 3);
+        Assert::IsTrue(Scanner::SkipStringText(end - 2, end) == end - 2);
+        Assert::IsTrue(Scanner::SkipStringText(end - 1, end) == end - 1);
+      }
+      const char separators[] = "@[`{/:\x80\xFF";
+      for (const char* separator = separators; *separator; ++separator) {
+        std::string text = std::string(40, 'q') + *separator;
+        Assert::IsTrue(Scanner::SkipIdentifier(text.data(),
+                                               text.data() + text.size()) ==
+                       text.data() + 40);
+      }
+      RunTest(L"full/1_input.txt", L"full/1_expected.txt");
+    }
+    Scanner::SetLevel(initial_level);
+  }
+
+  TEST_METHOD(Unicode_Identifiers) {
+    Assert::IsTrue(UnicodeClasses::IsIdentifierStart(U'_'));
+    Assert::IsFalse(UnicodeClasses::IsIdentifierStart(U'7'));
+    Assert::IsTrue(UnicodeClasses::IsIdentifierStart(U'\u00E9'));
+    Assert::IsTrue(UnicodeClasses::IsIdentifierStart(U'\u4E2D'));
+    Assert::IsTrue(UnicodeClasses::IsIdentifierStart(U'\U00020000'));
+    // Arabic-Indic digit three and a combining acute accent.
+    Assert::IsFalse(UnicodeClasses::IsIdentifierStart(U'\u0663'));
+    Assert::IsTrue(UnicodeClasses::IsIdentifierContinue(U'\u0663'));
+    Assert::IsFalse(UnicodeClasses::IsIdentifierStart(U'\u0301'));
+    Assert::IsTrue(UnicodeClasses::IsIdentifierContinue(U'\u0301'));
+    Assert::IsFalse(UnicodeClasses::IsIdentifierContinue(U'\u00D7'));
+    Assert::IsFalse(UnicodeClasses::IsDigit(U'\u0663'));
+    Assert::IsTrue(UnicodeClasses::IsHexDigit(U'F'));
+
+    const std::string valid =
+        "a\xC3\xA9\xE4\xB8\xAD\xF0\xA0\x80\x80 plain text";
+    Assert::IsTrue(FindInvalidUtf8(valid.data(), valid.data() + valid.size()) ==
+                   valid.data() + valid.size());
+    for (const char* invalid : {"\xC0\xAF", "\xE0\x80\xAF", "\xED\xA0\x80",
+                                "\xF4\x90\x80\x80", "\xF5\x80\x80\x80",
+                                "\xE4\xB8", "\x80"}) {
+      std::string text = "12345678" + std::string(invalid);
+      Assert::IsTrue(FindInvalidUtf8(text.data(), text.data() + text.size()) ==
+                     text.data() + 8);
+    }
+
+    // A long identifier spans several validation windows.
+    std::string long_name;
+    for (int i = 0; i < 10000; ++i) long_name += "\xC3\xA9";
+    const std::string source = "\xD0\xBF\xD1\x80\xD0\xB8 = a\xCC\x81 + " +
+                               long_name + "; \xF0\xA0\x80\x80 \xFF";
+    for (LexicAnalyzer::Engine engine : {LexicAnalyzer::Engine::STATE_MACHINE,
+                                         LexicAnalyzer::Engine::TABLE}) {
+      LexicAnalyzer analyzer{SourceBuffer(source.data(), source.size()),
+                             engine};
+      analyzer.SetMaxErrors(1);
+      TokenBuffer tokens = analyzer.GetTokens();
+      Assert::AreEqual(size_t(8), tokens.Size());
+      Assert::IsTrue(tokens[0].symbol == "\xD0\xBF\xD1\x80\xD0\xB8" &&
+                     tokens[0].type == Token::Type::IDENTIFIER);
+      Assert::IsTrue(tokens[2].symbol == "a\xCC\x81" &&
+                     tokens[2].type == Token::Type::IDENTIFIER);
+      Assert::IsTrue(tokens[4].symbol == long_name);
+      Assert::IsTrue(tokens[6].type == Token::Type::IDENTIFIER);
+      Assert::IsTrue(tokens[7].type == Token::Type::ERROR);
+      Assert::IsTrue(analyzer.GetDiagnostics()[0].code ==
+                     Diagnostic::Code::UNEXPECTED_SYMBOL);
+    }
+
+    // Overlong forms of '"' and '/' are no characters at all.
+    for (const char* overlong : {"\xE0\x80\xA2", "\xE0\x80\xAF",
+                                 "\xC0\xAF", "\xF0\x80\x80\xAF"}) {
+      std::string text = std::string("x") + overlong + "y\"";
+      Assert::IsTrue(DecodeUtf8(text.data() + 1, text.data() + text.size()) ==
+                     0xFFFD);
+      for (LexicAnalyzer::Engine engine :
+           {LexicAnalyzer::Engine::STATE_MACHINE,
+            LexicAnalyzer::Engine::TABLE}) {
+        LexicAnalyzer analyzer{SourceBuffer(text.data(), text.size()),
+                               engine};
+        bool caught = false;
+        try {
+          analyzer.GetTokens();
+        } catch (std::runtime_error& e) {
+          caught = std::string(e.what()).find("unexpected symbol") !=
+                   std::string::npos;
+        }
+        Assert::IsTrue(caught, L"OVERLONG FORM ACCEPTED");
+      }
+    }
+  }
+
+  TEST_METHOD(Vocabulary_DefaultMatchesLists) {
+    LexerVocabulary loaded("lists");
+    std::shared_ptr<const LexerVocabulary> compiled_in =
+        LexerVocabulary::Default();
+    Assert::IsTrue(compiled_in == LexerVocabulary::Default());
+    size_t operator_count = 0;
+    for (const std::string& oper : loaded.GetOperators()) {
+      if (oper.empty()) continue;
+      Assert::IsTrue(compiled_in->IsOperator(oper));
+      ++operator_count;
+    }
+    Assert::IsTrue(operator_count == compiled_in->GetOperators().size());
+    for (std::string_view word : StaticVocabulary::kReserved) {
+      Assert::IsTrue(loaded.IsReserved(word));
+    }
+    for (char32_t symbol = 1; symbol < 128; ++symbol) {
+      Assert::IsTrue(loaded.IsPunctuation(symbol) ==
+                     compiled_in->IsPunctuation(symbol));
+      Assert::IsTrue(loaded.ToControl(symbol) ==
+                     compiled_in->ToControl(symbol));
+    }
+  }
+
+  TEST_METHOD(Batch_SharedVocabulary) {
+    const std::wstring names[] = {L"full/1", L"full/2", L"full/4",
+                                  L"numbers/1", L"operators/3",
+                                  L"literals/1"};
+    std::vector<std::string> input_files;
+    for (const std::wstring& name : names) {
+      input_files.push_back(std::filesystem::path(
+          GetTestsPath() + name + L"_input.txt").string());
+    }
+    input_files.push_back(input_files.front());
+    input_files.push_back(std::filesystem::path(
+        GetTestsPath() + L"full/3_input.txt").string());
+
+    BatchLexer batch(LexerVocabulary::Default(),
+                     LexicAnalyzer::Engine::STATE_MACHINE, 4);
+    std::vector<BatchLexer::Result> results = batch.Run(input_files);
+    Assert::IsTrue(results.size() == input_files.size());
+    for (size_t i = 0; i + 1 < results.size(); ++i) {
+      Assert::IsTrue(results[i].input_file == input_files[i]);
+      Assert::IsTrue(results[i].error.empty(), L"BATCH FILE FAILED");
+      std::wstring expected_name = i < std::size(names) ? names[i] : names[0];
+      std::ifstream file_expected(std::filesystem::path(
+          GetTestsPath() + expected_name + L"_expected.txt"));
+      std::ifstream file_actual(results[i].output_file);
+      std::string expected_line, actual_line;
+      while (std::getline(file_expected, expected_line)) {
+        Assert::IsTrue(std::getline(file_actual, actual_line) &&
+                       actual_line == expected_line,
+                       L"BATCH OUTPUT DOES NOT MATCH");
+      }
+      Assert::IsFalse(std::getline(file_actual, actual_line).good());
+    }
+    Assert::IsFalse(results.back().error.empty(), L"BATCH ERROR NOT KEPT");
+    for (const BatchLexer::Result& result : results) {
+      std::filesystem::remove(result.output_file);
+    }
+  }
+
+  TEST_METHOD(Parallel_MatchesSequential) {
+    // Seams fall between every two lines, next to literals with escapes
+    // and a comment with a quote in it; the error on the last line must
+    // carry its line in the whole source.
+    const std::string source =
+        "var a = \"x\\ny\\\"z\";\n# comment \"\nfunc f(b) { return b; }\n"
+        "c = 0x1F + 12.5e3;\n'q' d \"\xC3\xA9\\\\\"\n\nb = 1e\n";
+    const LexicAnalyzer::Engine engines[] = {
+        LexicAnalyzer::Engine::STATE_MACHINE, LexicAnalyzer::Engine::TABLE};
+    auto vocabulary = LexerVocabulary::Default();
+    for (LexicAnalyzer::Engine engine : engines) {
+      LexicAnalyzer sequential(SourceBuffer::View(source.data(),
+                                                  source.size()),
+                               vocabulary, engine);
+      std::vector<Token> expected_tokens;
+      std::string expected_error;
+      Token token;
+      try {
+        while (sequential.NextToken(token)) expected_tokens.push_back(token);
+      } catch (std::runtime_error& e) {
+        expected_error = e.what();
+      }
+      Assert::IsTrue(expected_error.find("at line 7") != std::string::npos);
+
+      SourceBuffer buffer = SourceBuffer::View(source.data(), source.size());
+      for (size_t chunk_size = 1; chunk_size < source.size();
+           chunk_size += 3) {
+        ParallelLexer parallel(vocabulary, engine, 3, chunk_size);
+        std::string actual_error;
+        try {
+          parallel.Lex(buffer);
+        } catch (std::runtime_error& e) {
+          actual_error = e.what();
+        }
+        Assert::IsTrue(actual_error == expected_error, L"ERRORS DIFFER");
+        const std::vector<Token>& actual_tokens = parallel.GetTokens();
+        Assert::IsTrue(actual_tokens.size() == expected_tokens.size());
+        for (size_t i = 0; i < actual_tokens.size(); ++i) {
+          Assert::IsTrue(actual_tokens[i].type == expected_tokens[i].type &&
+                         actual_tokens[i].symbol == expected_tokens[i].symbol,
+                         L"TOKENS DO NOT MATCH");
+        }
+      }
+    }
+  }
+
+  TEST_METHOD(Numbers_TypedValues) {
+    const char source[] =
+        "007 000 0x1F 18446744073709551615 1.5e3 25e-1 1e-400";
+    for (LexicAnalyzer::Engine engine : {LexicAnalyzer::Engine::STATE_MACHINE,
+                                         LexicAnalyzer::Engine::TABLE}) {
+      LexicAnalyzer analyzer{SourceBuffer(source, sizeof(source) - 1),
+                             engine};
+      TokenBuffer tokens = analyzer.GetTokens();
+      Assert::AreEqual(size_t(7), tokens.Size());
+      Token token = tokens[0];
+      Assert::IsTrue(token.symbol == "7" &&
+                     token.value_type == Token::ValueType::INTEGER &&
+                     token.value.integer == 7);
+      Assert::IsTrue(tokens[1].symbol == "0" &&
+                     tokens[1].value.integer == 0);
+      Assert::IsTrue(tokens[2].symbol == "0x1F" &&
+                     tokens[2].value.integer == 0x1F);
+      Assert::IsTrue(tokens[3].value.integer == UINT64_MAX);
+      Assert::IsTrue(tokens[4].value_type == Token::ValueType::REAL &&
+                     tokens[4].value.real == 1500.0);
+      Assert::IsTrue(tokens[5].value.real == 2.5);
+      Assert::IsTrue(tokens[6].value.real == 0.0);
+    }
+
+    for (const char* overflow : {"18446744073709551616", "0x10000000000000000",
+                                 "1e400"}) {
+      for (LexicAnalyzer::Engine engine :
+           {LexicAnalyzer::Engine::STATE_MACHINE,
+            LexicAnalyzer::Engine::TABLE}) {
+        LexicAnalyzer analyzer{
+            SourceBuffer(overflow, std::string_view(overflow).size()),
+            engine};
+        bool caught = false;
+        try {
+          analyzer.GetTokens();
+        } catch (std::runtime_error& e) {
+          caught = true;
+        }
+        Assert::IsTrue(caught, L"OUT OF RANGE CONSTANT DID NOT THROW");
+      }
+    }
+  }
+
+  TEST_METHOD(Interner_SharedIds) {
+    const char source[] = "let counter = counter + other; counter = 0;";
+    auto interner = std::make_shared<StringInterner>();
+    for (LexicAnalyzer::Engine engine : {LexicAnalyzer::Engine::STATE_MACHINE,
+                                         LexicAnalyzer::Engine::TABLE}) {
+      LexicAnalyzer analyzer(SourceBuffer(source, sizeof(source) - 1),
+                             LexerVocabulary::Default(), engine, 1,
+                             interner);
+      std::map<std::string_view, uint32_t> ids;
+      for (const Token& token : analyzer.Tokens()) {
+        if (token.type != Token::Type::IDENTIFIER) {
+          Assert::IsTrue(token.symbol_id == Token::kNoSymbol);
+          continue;
+        }
+        Assert::IsTrue(interner->GetText(token.symbol_id) == token.symbol);
+        auto inserted = ids.emplace(token.symbol, token.symbol_id);
+        Assert::AreEqual(inserted.first->second, token.symbol_id);
+      }
+      Assert::AreEqual(size_t(2), ids.size());
+    }
+    Assert::AreEqual(size_t(2), interner->Size());
+
+    // Concurrent interning of overlapping names still yields one dense id
+    // per name.
+    const size_t kNames = 1000;
+    ThreadPool pool(8);
+    std::vector<std::vector<uint32_t>> ids(8, std::vector<uint32_t>(kNames));
+    for (size_t task = 0; task < ids.size(); ++task) {
+      pool.Submit([&interner, &ids, task, kNames] {
+        for (size_t i = 0; i < kNames; ++i) {
+          size_t name = (i + task * 397) % kNames;
+          ids[task][name] = interner->Intern("name" + std::to_string(name));
+        }
+      });
+    }
+    pool.Wait();
+    Assert::AreEqual(kNames + 2, interner->Size());
+    for (size_t name = 0; name < kNames; ++name) {
+      Assert::IsTrue(ids[0][name] < kNames + 2);
+      Assert::IsTrue(interner->GetText(ids[0][name]) ==
+                     "name" + std::to_string(name));
+      for (const std::vector<uint32_t>& task_ids : ids) {
+        Assert::AreEqual(ids[0][name], task_ids[name]);
+      }
+    }
+  }
+
+  TEST_METHOD(Tokens_OffsetsAndLocations) {
+    const char source[] = "let a = 1;\n  # comment\n\tb = \"x\\ny\" + 0x1F;\n";
+    const size_t expected_offsets[] = {0, 4, 6, 8, 9, 24, 26, 28, 35, 37, 41};
+    for (LexicAnalyzer::Engine engine : {LexicAnalyzer::Engine::STATE_MACHINE,
+                                         LexicAnalyzer::Engine::TABLE}) {
+      LexicAnalyzer analyzer{SourceBuffer(source, sizeof(source) - 1),
+                             engine};
+      size_t i = 0;
+      for (const Token& token : analyzer.Tokens()) {
+        Assert::IsTrue(i < std::size(expected_offsets));
+        Assert::AreEqual(expected_offsets[i++], size_t(token.offset));
+      }
+      Assert::AreEqual(std::size(expected_offsets), i);
+      LineIndex::Location location = analyzer.GetLocation(28);
+      Assert::AreEqual(size_t(3), location.line);
+      Assert::AreEqual(size_t(5), location.column);
+    }
+
+    // Columns count characters, not bytes.
+    const char utf8[] = "\"\xD0\xB0\xD0\xB1\" + 1;\n\"\xD0\xB2\" `";
+    LexicAnalyzer analyzer{SourceBuffer(utf8, sizeof(utf8) - 1)};
+    LineIndex::Location location = analyzer.GetLocation(sizeof(utf8) - 2);
+    Assert::AreEqual(size_t(2), location.line);
+    Assert::AreEqual(size_t(4), location.column);
+    std::string message;
+    try {
+      analyzer.GetTokens();
+    } catch (std::runtime_error& e) {
+      message = e.what();
+    }
+    Assert::IsTrue(message.find("at line 2 char 4") != std::string::npos);
+  }
+
+  TEST_METHOD(Recovery_AllDiagnostics) {
+    const char source[] =
+        "a = 1e+x; b = `;\n"
+        "c = 'ab' + 0x;\n"
+        "d = \"open\n"
+        "e = 99999999999999999999;\n";
+    const std::vector<std::string> expected_errors = {
+        "1e+x", "`", "'ab'", "0x", "\"open", "99999999999999999999"};
+    for (LexicAnalyzer::Engine engine : {LexicAnalyzer::Engine::STATE_MACHINE,
+                                         LexicAnalyzer::Engine::TABLE}) {
+      LexicAnalyzer analyzer{SourceBuffer(source, sizeof(source) - 1),
+                             engine};
+      analyzer.SetMaxErrors(10);
+      std::vector<std::string> errors;
+      size_t identifiers = 0;
+      for (const Token& token : analyzer.Tokens()) {
+        if (token.type == Token::Type::ERROR) {
+          errors.emplace_back(token.symbol);
+        } else if (token.type == Token::Type::IDENTIFIER) {
+          ++identifiers;
+        }
+      }
+      Assert::IsTrue(errors == expected_errors, L"ERROR TOKENS DO NOT MATCH");
+      Assert::AreEqual(size_t(5), identifiers);
+      const std::vector<Diagnostic>& diagnostics = analyzer.GetDiagnostics();
+      Assert::AreEqual(expected_errors.size(), diagnostics.size());
+      Assert::IsTrue(diagnostics[1].code ==
+                     Diagnostic::Code::UNEXPECTED_SYMBOL);
+      Assert::IsTrue(diagnostics[4].code ==
+                     Diagnostic::Code::UNTERMINATED_LITERAL);
+      Assert::IsTrue(analyzer.FormatDiagnostic(diagnostics[2]).find(
+                         "at line 2 char 6") != std::string::npos);
+    }
+
+    std::string many_errors;
+    for (int i = 0; i < 20; ++i) many_errors += "` ";
+    LexicAnalyzer analyzer{
+        SourceBuffer(many_errors.data(), many_errors.size())};
+    analyzer.SetMaxErrors(5);
+    Assert::AreEqual(size_t(5), analyzer.GetTokens().Size());
+    Assert::AreEqual(size_t(6), analyzer.GetDiagnostics().size());
+    Assert::IsTrue(analyzer.GetDiagnostics().back().code ==
+                   Diagnostic::Code::TOO_MANY_ERRORS);
+  }
+
+  TEST_METHOD(Literal_Escapes) {
+    // Plain runs longer than a vector, around escapes and non-ASCII text.
+    const std::string plain = std::string(50, 'p') + "\xC3\xA9";
+    const std::string source = "s = \"" + plain + "\\t\\\"" + plain +
+                               "\\\\\"; c = '\\n';";
+    const std::string expected = plain + "\t\"" + plain + "\\";
+    const char* const invalid[] = {"\"a\\qb\"", "'\\q'",
+                                   "\"\\\xC3\xA9\""};
+    for (LexicAnalyzer::Engine engine : {LexicAnalyzer::Engine::STATE_MACHINE,
+                                         LexicAnalyzer::Engine::TABLE}) {
+      LexicAnalyzer analyzer{SourceBuffer(source.data(), source.size()),
+                             engine};
+      TokenBuffer tokens = analyzer.GetTokens();
+      Assert::AreEqual(size_t(8), tokens.Size());
+      Assert::IsTrue(tokens[2].symbol == expected &&
+                     tokens[2].type == Token::Type::LITCONSTANT);
+      Assert::IsTrue(tokens[6].symbol == "\n");
+
+      for (const char* literal : invalid) {
+        LexicAnalyzer throwing{
+            SourceBuffer(literal, std::string_view(literal).size()), engine};
+        bool caught = false;
+        try {
+          throwing.GetTokens();
+        } catch (std::runtime_error& e) {
+          caught = std::string(e.what()).find("unknown escape sequence") !=
+                   std::string::npos;
+        }
+        Assert::IsTrue(caught, L"UNKNOWN ESCAPE DID NOT THROW");
+      }
+
+      // The error spans the literal, escaped quotes included, and lexing
+      // goes on after it; a backslash ending the line leaves it open.
+      const char recovering[] = "a = \"x\\q\\\"y\" + b;\nc = \"z\\\nd;";
+      LexicAnalyzer recovery{
+          SourceBuffer(recovering, sizeof(recovering) - 1), engine};
+      recovery.SetMaxErrors(10);
+      std::vector<std::string> symbols;
+      for (const Token& token : recovery.Tokens()) {
+        symbols.emplace_back(token.symbol);
+      }
+      const std::vector<std::string> expected_symbols = {
+          "a", "=", "\"x\\q\\\"y\"", "+", "b", ";",
+          "c", "=", "\"z\\", "d", ";"};
+      Assert::IsTrue(symbols == expected_symbols, L"TOKENS DO NOT MATCH");
+      const std::vector<Diagnostic>& diagnostics = recovery.GetDiagnostics();
+      Assert::AreEqual(size_t(2), diagnostics.size());
+      Assert::IsTrue(diagnostics[0].code == Diagnostic::Code::INVALID_ESCAPE);
+      Assert::IsTrue(diagnostics[1].code ==
+                     Diagnostic::Code::UNTERMINATED_LITERAL);
+    }
+  }
+
+  TEST_METHOD(Literal_QuoteAtEnd) {
+    for (const char* source : {"a \"", "a '"}) {
+      for (LexicAnalyzer::Engine engine :
+           {LexicAnalyzer::Engine::STATE_MACHINE,
+            LexicAnalyzer::Engine::TABLE}) {
+        LexicAnalyzer throwing{
+            SourceBuffer(source, std::string_view(source).size()), engine};
+        bool caught = false;
+        try {
+          throwing.GetTokens();
+        } catch (std::runtime_error& e) {
+          caught = std::string(e.what()).find(
+                       Diagnostic::kUnterminatedLiteral) != std::string::npos;
+        }
+        Assert::IsTrue(caught, L"QUOTE AT THE END DID NOT THROW");
+
+        LexicAnalyzer recovering{
+            SourceBuffer(source, std::string_view(source).size()), engine};
+        recovering.SetMaxErrors(10);
+        TokenBuffer tokens = recovering.GetTokens();
+        Assert::AreEqual(size_t(2), tokens.Size());
+        Assert::IsTrue(tokens[1].type == Token::Type::ERROR &&
+                       tokens[1].symbol == std::string_view(source + 2));
+        Assert::AreEqual(size_t(1), recovering.GetDiagnostics().size());
+        Assert::IsTrue(recovering.GetDiagnostics()[0].code ==
+                       Diagnostic::Code::UNTERMINATED_LITERAL);
+      }
+    }
+  }
+
+  TEST_METHOD(TokenBuffer_RandomAccess) {
+    const char source[] = "x = 12 + y * 2.5; z = x";
+    LexicAnalyzer analyzer{SourceBuffer(source, sizeof(source) - 1)};
+    Token x;
+    Token equals;
+    Assert::IsTrue(analyzer.NextToken(x) && x.symbol == "x");
+    Assert::IsTrue(analyzer.NextToken(equals) && equals.symbol == "=");
+    // Tokens already taken are not in the buffer.
+    TokenBuffer tokens = analyzer.GetTokens();
+    Assert::AreEqual(size_t(9), tokens.Size());
+    Assert::IsTrue(tokens.GetType(0) == Token::Type::NUMCONSTANT &&
+                   tokens[0].value.integer == 12);
+    Assert::AreEqual(uint32_t(4), tokens.GetOffset(0));
+    Assert::IsTrue(tokens[4].value_type == Token::ValueType::REAL &&
+                   tokens[4].value.real == 2.5);
+    Assert::IsTrue(tokens[8].symbol_id == x.symbol_id &&
+                   tokens[2].symbol_id != x.symbol_id);
+    Assert::IsTrue(tokens[3].symbol_id == Token::kNoSymbol);
+
+    tokens.Erase(4);
+    Assert::AreEqual(size_t(5), tokens.Size());
+    Assert::IsTrue(tokens[0].value.real == 2.5 && tokens.GetSymbol(4) == "x");
+    TokenBuffer moved = std::move(tokens);
+    Assert::AreEqual(size_t(5), moved.Size());
+    moved.Clear();
+    Assert::IsTrue(moved.IsEmpty());
+  }
+
+  TEST_METHOD(Parser_Programs) {
+    Assert::AreEqual(size_t(16), sizeof(Ast::Node));
+    std::string program =
+        "import \"IO.h\"\n"
+        "func Fold(unsigned int32 @items, count) : int64 {\n"
+        "  let sum : int64 = 0;\n"
+        "  for (var i = 0; i < count; i += 1) sum = sum + items[i];\n"
+        "  if (sum > 9) return sum; elif (sum) return 1; else { return; }\n"
+        "  while (sum) do { sum--; break; } while (not done);\n"
+        "}\n";
+    Assert::IsTrue(ParseToText(program) ==
+                   "PROGRAM\n"
+                   "  IMPORT IO.h\n"
+                   "  FUNCTION Fold\n"
+                   "    PARAMETER items\n"
+                   "      TYPE unsigned int32 @\n"
+                   "    PARAMETER count\n"
+                   "    TYPE int64\n"
+                   "    BLOCK\n"
+                   "      DECLARATION let\n"
+                   "        NAME sum\n"
+                   "        TYPE int64\n"
+                   "        NUMBER 0\n"
+                   "      FOR\n"
+                   "        DECLARATION var\n"
+                   "          NAME i\n"
+                   "          NUMBER 0\n"
+                   "        BINARY <\n"
+                   "          NAME i\n"
+                   "          NAME count\n"
+                   "        BINARY +=\n"
+                   "          NAME i\n"
+                   "          NUMBER 1\n"
+                   "        EXPRESSION\n"
+                   "          BINARY =\n"
+                   "            NAME sum\n"
+                   "            BINARY +\n"
+                   "              NAME sum\n"
+                   "              INDEX\n"
+                   "                NAME items\n"
+                   "                NAME i\n"
+                   "      IF if\n"
+                   "        BINARY >\n"
+                   "          NAME sum\n"
+                   "          NUMBER 9\n"
+                   "        RETURN\n"
+                   "          NAME sum\n"
+                   "        IF elif\n"
+                   "          NAME sum\n"
+                   "          RETURN\n"
+                   "            NUMBER 1\n"
+                   "          BLOCK\n"
+                   "            RETURN\n"
+                   "      WHILE\n"
+                   "        NAME sum\n"
+                   "        DO_WHILE\n"
+                   "          BLOCK\n"
+                   "            EXPRESSION\n"
+                   "              POSTFIX --\n"
+                   "                NAME sum\n"
+                   "            JUMP break\n"
+                   "          PREFIX not\n"
+                   "            NAME done\n");
+
+    for (const wchar_t* input : {L"full/1_input.txt", L"full/2_input.txt",
+                                 L"full/4_input.txt"}) {
+      SourceBuffer source(
+          std::filesystem::path(GetTestsPath() + input).string());
+      LexicAnalyzer analyzer(std::move(source));
+      size_t token_count = 0;
+      {
+        LexicAnalyzer counter{SourceBuffer(
+            std::filesystem::path(GetTestsPath() + input).string())};
+        token_count = counter.GetTokens().Size();
+      }
+      Parser parser(analyzer);
+      Ast ast = parser.Parse();
+      Assert::IsTrue(ast.Size() > 1 && ast.Size() <= token_count + 1);
+      Assert::IsTrue(ast.GetNode(ast.GetRoot()).kind == Ast::Kind::PROGRAM);
+    }
+  }
+
+  TEST_METHOD(Parser_Precedence) {
+    Assert::IsTrue(ParseToText("a = b = -c ** d ** e * f(g, h)[1] - i;") ==
+                   "PROGRAM\n"
+                   "  EXPRESSION\n"
+                   "    BINARY =\n"
+                   "      NAME a\n"
+                   "      BINARY =\n"
+                   "        NAME b\n"
+                   "        BINARY -\n"
+                   "          BINARY *\n"
+                   "            PREFIX -\n"
+                   "              BINARY **\n"
+                   "                NAME c\n"
+                   "                BINARY **\n"
+                   "                  NAME d\n"
+                   "                  NAME e\n"
+                   "            INDEX\n"
+                   "              CALL\n"
+                   "                NAME f\n"
+                   "                NAME g\n"
+                   "                NAME h\n"
+                   "              NUMBER 1\n"
+                   "          NAME i\n");
+    Assert::IsTrue(ParseToText("x = a or b and c | d ^ e & f == g < h;") ==
+                   "PROGRAM\n"
+                   "  EXPRESSION\n"
+                   "    BINARY =\n"
+                   "      NAME x\n"
+                   "      BINARY or\n"
+                   "        NAME a\n"
+                   "        BINARY and\n"
+                   "          NAME b\n"
+                   "          BINARY |\n"
+                   "            NAME c\n"
+                   "            BINARY ^\n"
+                   "              NAME d\n"
+                   "              BINARY &\n"
+                   "                NAME e\n"
+                   "                BINARY ==\n"
+                   "                  NAME f\n"
+                   "                  BINARY <\n"
+                   "                    NAME g\n"
+                   "                    NAME h\n");
+    Assert::IsTrue(ParseToText("p->q->r(NIL);") ==
+                   "PROGRAM\n"
+                   "  EXPRESSION\n"
+                   "    CALL\n"
+                   "      MEMBER\n"
+                   "        MEMBER\n"
+                   "          NAME p\n"
+                   "          NAME q\n"
+                   "        NAME r\n"
+                   "      NIL NIL\n");
+  }
+
+  TEST_METHOD(Parser_Errors) {
+    Assert::IsTrue(ParseError("let = 5;").find(
+                       "expected an identifier\nat line 1 char 4 \"=\"") !=
+                   std::string::npos);
+    Assert::IsTrue(ParseError("func f() {\n  g(1)\n}").find(
+                       "expected ;\nat line 3 char 0 \"}\"") !=
+                   std::string::npos);
+    Assert::IsTrue(ParseError("func f() { return 1;").find(
+                       "closing bracket } is not found") != std::string::npos);
+    Assert::IsTrue(ParseError("x = (1 + 2;").find("expected )") !=
+                   std::string::npos);
+    Assert::IsTrue(ParseError("").empty());
+    // Too deep to parse, but no stack overflow.
+    std::string nested = std::string(100000, '(') + "1" +
+                         std::string(100000, ')') + ";";
+    Assert::IsTrue(ParseError(nested).find("nesting is too deep") !=
+                   std::string::npos);
+    // A long elif chain is flat, so it does not count towards the nesting.
+    std::string chain = "if (a) b;";
+    for (int i = 0; i < 2000; ++i) chain += " elif (a) b;";
+    Assert::IsTrue(ParseError(chain + " else b;").empty());
+
+    const char source[] = "let a = 1; let b = `;";
+    LexicAnalyzer analyzer{SourceBuffer(source, sizeof(source) - 1)};
+    analyzer.SetMaxErrors(10);
+    Parser parser(analyzer);
+    bool caught = false;
+    try {
+      parser.Parse();
+    } catch (std::runtime_error& e) {
+      caught = std::string(e.what()).find("\"`\"") != std::string::npos;
+    }
+    Assert::IsTrue(caught, L"ERROR TOKEN WAS PARSED");
+    Assert::AreEqual(size_t(1), analyzer.GetDiagnostics().size());
+  }
+
+  TEST_METHOD(TokenStream_RoundTrip) {
+    const char source[] = "x = 0x1F + x * 2.5;\ns = \"x\" + 'c'; x = 31;\n";
+    LexicAnalyzer analyzer{SourceBuffer(source, sizeof(source) - 1)};
+    std::vector<Token> tokens;
+    for (const Token& token : analyzer.Tokens()) tokens.push_back(token);
+    std::string file_name =
+        (std::filesystem::temp_directory_path() / "round_trip.tokens.bin")
+            .string();
+    {
+      std::ofstream output(file_name, std::ios::out | std::ios::binary);
+      BatchLexer::WriteTokens(tokens, output,
+                              BatchLexer::OutputFormat::BINARY);
+    }
+    {
+      TokenStreamReader reader(file_name);
+      Assert::AreEqual(tokens.size(), reader.Size());
+      for (size_t i = 0; i < tokens.size(); ++i) {
+        Token token = reader.GetToken(i);
+        Assert::IsTrue(token.type == tokens[i].type);
+        Assert::IsTrue(token.symbol == tokens[i].symbol);
+        Assert::IsTrue(token.value_type == tokens[i].value_type);
+        Assert::AreEqual(tokens[i].offset, token.offset);
+        Assert::AreEqual(tokens[i].value.integer, token.value.integer);
+      }
+      // Equal symbols share one pool string.
+      Assert::IsTrue(reader.GetSymbol(0).data() ==
+                     reader.GetSymbol(4).data());
+      Assert::AreEqual(reader.GetToken(0).symbol_id,
+                       reader.GetToken(4).symbol_id);
+    }
+    // A kind past the last type or value type.
+    for (char kind : {'\x0F', '\x31'}) {
+      {
+        std::fstream file(file_name,
+                          std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(TokenStreamHeader));
+        file.put(kind);
+      }
+      bool is_corrupted = false;
+      try {
+        TokenStreamReader reader(file_name);
+      } catch (const std::runtime_error&) {
+        is_corrupted = true;
+      }
+      Assert::IsTrue(is_corrupted, L"INVALID TOKEN KIND ACCEPTED");
+    }
+
+    {
+      std::ofstream output(file_name, std::ios::out | std::ios::binary);
+      output << "IDENTIFIER x\n";
+    }
+    bool is_rejected = false;
+    try {
+      TokenStreamReader reader(file_name);
+    } catch (const std::runtime_error&) {
+      is_rejected = true;
+    }
+    Assert::IsTrue(is_rejected, L"TEXT OUTPUT ACCEPTED AS A TOKEN FILE");
+    std::filesystem::remove(file_name);
+  }
+
+  TEST_METHOD(TokenCache_HitsAndEviction) {
+    std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "token_cache_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::string sources[] = {"a = 1;\n", "b = \"x\" + 2.5;\n", "` c\n"};
+    std::vector<std::string> input_files;
+    for (size_t i = 0; i < std::size(sources); ++i) {
+      input_files.push_back(
+          (directory / ("source_" + std::to_string(i))).string());
+      std::ofstream(input_files.back(), std::ios::binary) << sources[i];
+    }
+    auto vocabulary = LexerVocabulary::Default();
+    std::string cache_directory = (directory / "cache").string();
+    std::vector<std::string> lexed_outputs;
+    for (int run = 0; run < 2; ++run) {
+      auto cache = std::make_shared<TokenCache>(cache_directory, *vocabulary);
+      BatchLexer batch(vocabulary, LexicAnalyzer::Engine::STATE_MACHINE, 2);
+      batch.SetCache(cache);
+      std::vector<BatchLexer::Result> results = batch.Run(input_files);
+      Assert::IsFalse(results[2].error.empty());
+      // The file with an error is never stored, so it always misses.
+      TokenCache::Stats stats = cache->GetStats();
+      Assert::AreEqual(size_t(run == 0 ? 0 : 2), stats.hits);
+      Assert::AreEqual(size_t(run == 0 ? 3 : 1), stats.misses);
+      Assert::AreEqual(size_t(2), stats.entries);
+      for (size_t i = 0; i < 2; ++i) {
+        std::ifstream output(results[i].output_file);
+        std::string text((std::istreambuf_iterator<char>(output)),
+                         std::istreambuf_iterator<char>());
+        if (run == 0) {
+          lexed_outputs.push_back(text);
+        } else {
+          Assert::IsTrue(text == lexed_outputs[i], L"CACHED OUTPUT DIFFERS");
+        }
+      }
+    }
+    // Entries are per engine.
+    auto table_cache = std::make_shared<TokenCache>(cache_directory,
+                                                    *vocabulary);
+    BatchLexer table_batch(vocabulary, LexicAnalyzer::Engine::TABLE, 2);
+    table_batch.SetCache(table_cache);
+    table_batch.Run(input_files);
+    Assert::AreEqual(size_t(0), table_cache->GetStats().hits);
+
+    LexicAnalyzer analyzer{SourceBuffer(sources[0].data(),
+                                        sources[0].size())};
+    TokenStreamWriter writer;
+    for (const Token& token : analyzer.Tokens()) writer.Add(token);
+    std::ostringstream entry;
+    writer.Write(entry);
+    TokenCache cache((directory / "lru").string(), *vocabulary,
+                     2 * entry.str().size());
+    cache.Store(1, writer);
+    cache.Store(2, writer);
+    Assert::IsTrue(cache.Find(1) != nullptr);
+    cache.Store(3, writer);
+    Assert::IsTrue(cache.Find(2) == nullptr, L"LRU ENTRY NOT EVICTED");
+    Assert::IsTrue(cache.Find(1) != nullptr && cache.Find(3) != nullptr);
+    Assert::AreEqual(size_t(1), cache.GetStats().evictions);
+    std::filesystem::remove_all(directory);
+  }
+
+  TEST_METHOD(Incremental_MatchesFullLex) {
+    const std::string pieces[] = {
+        "a", "b1", " ", "\n", "# c\n", "\"s\\n\"", "\"", "'x'", "'", "12",
+        "0x1F", "3.5e2", "1e", ".", "+", "+=", "==", "(", ";", "`", "\\",
+        "\xC3", "\xA9", "\xC3\xA9", "\xE4\xB8\xAD", "\xC3\x97"};
+    auto vocabulary = LexerVocabulary::Default();
+    for (LexicAnalyzer::Engine engine : {LexicAnalyzer::Engine::STATE_MACHINE,
+                                         LexicAnalyzer::Engine::TABLE}) {
+      IncrementalLexer lexer(
+          "var a = \"x\\ty\";\n# note\nb += 0x1F * (a - 2.5);\n",
+          vocabulary, engine);
+      uint32_t seed = 12345;
+      auto next = [&seed](size_t bound) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) % bound;
+      };
+      for (int edit = 0; edit < 1000; ++edit) {
+        size_t size = lexer.GetText().size();
+        size_t offset = next(size + 1);
+        size_t removed = next(std::min<size_t>(size - offset, 4) + 1);
+        std::string inserted;
+        for (size_t i = next(3); i > 0; --i) {
+          inserted += pieces[next(std::size(pieces))];
+        }
+        if (size > 300) removed = std::min<size_t>(size - offset, 40);
+        lexer.Edit(offset, removed, inserted);
+
+        std::string_view text = lexer.GetText();
+        LexicAnalyzer analyzer{SourceBuffer(text.data(), text.size()),
+                               vocabulary, engine};
+        analyzer.SetMaxErrors(SIZE_MAX);
+        std::vector<Token> expected;
+        for (const Token& token : analyzer.Tokens()) {
+          expected.push_back(token);
+        }
+        Assert::AreEqual(expected.size(), lexer.GetTokenCount());
+        for (size_t i = 0; i < expected.size(); ++i) {
+          Token actual = lexer.GetToken(i);
+          Assert::IsTrue(actual.type == expected[i].type &&
+                         actual.symbol == expected[i].symbol &&
+                         actual.offset == expected[i].offset &&
+                         actual.value.integer == expected[i].value.integer,
+                         L"INCREMENTAL TOKENS DO NOT MATCH");
+        }
+        const std::vector<Diagnostic>& diagnostics = analyzer.GetDiagnostics();
+        Assert::AreEqual(diagnostics.size(), lexer.GetDiagnosticCount());
+        for (size_t i = 0; i < diagnostics.size(); ++i) {
+          Diagnostic actual = lexer.GetDiagnostic(i);
+          Assert::IsTrue(actual.code == diagnostics[i].code &&
+                             actual.offset == diagnostics[i].offset,
+                         L"INCREMENTAL DIAGNOSTICS DO NOT MATCH");
+        }
+      }
+    }
+
+    // Completing a split UTF-8 sequence right behind an identifier joins
+    // the two, as does changing the character that follows it.
+    for (LexicAnalyzer::Engine engine : {LexicAnalyzer::Engine::STATE_MACHINE,
+                                         LexicAnalyzer::Engine::TABLE}) {
+      IncrementalLexer split("a\xC3 = 1;", vocabulary, engine);
+      split.Edit(2, 0, "\xA9");
+      Assert::IsTrue(split.GetToken(0).symbol == "a\xC3\xA9",
+                     L"SPLIT SEQUENCE NOT JOINED");
+      IncrementalLexer times("a\xC3\x97 = 1;", vocabulary, engine);
+      times.Edit(2, 1, "\xA9");
+      Assert::IsTrue(times.GetToken(0).symbol == "a\xC3\xA9",
+                     L"CHANGED CHARACTER NOT JOINED");
+      Assert::AreEqual(size_t(4), times.GetTokenCount());
+      Assert::AreEqual(size_t(0), times.GetDiagnosticCount());
+    }
+
+    std::string text;
+    for (int line = 0; line < 1000; ++line) text += "a = b + 1;\n";
+    IncrementalLexer lexer(text, vocabulary);
+    IncrementalLexer::Change change = lexer.Edit(text.size() / 2, 0, "c");
+    Assert::IsTrue(change.removed_tokens <= 3 && change.inserted_tokens <= 3,
+                   L"EDIT RE-LEXED TOO MUCH");
+    Assert::AreEqual(size_t(6000), lexer.GetTokenCount());
+
+    // Typing in the middle of a text a hundred times as long costs about
+    // as much: nothing is rebased or moved but around the edit.
+    auto time_typing = [&vocabulary](int lines) {
+      std::string text;
+      for (int line = 0; line < lines; ++line) text += "a = b + 1;\n";
+      IncrementalLexer lexer(text, vocabulary);
+      size_t offset = text.size() / 2;
+      lexer.Edit(offset, 0, " ");
+      auto start = std::chrono::steady_clock::now();
+      for (int edit = 0; edit < 2000; ++edit) {
+        lexer.Edit(offset + 1, 0, "c");
+        lexer.Edit(offset + 1, 1, "");
+      }
+      return std::chrono::steady_clock::now() - start;
+    };
+    auto small = time_typing(1000);
+    auto large = time_typing(100000);
+    Assert::IsTrue(large < small * 10, L"EDIT COST GROWS WITH THE TEXT");
+
+    // Re-lexing a long literal with an escape leaves its old copies behind
+    // until they are compacted away.
+    std::string literal = "\"" + std::string(1000, 'x') + "\\n\"";
+    IncrementalLexer literals("a = " + literal + ";", vocabulary);
+    for (int edit = 0; edit < 200; ++edit) {
+      literals.Edit(5, 1, edit % 2 == 0 ? "y" : "x");
+    }
+    Assert::IsTrue(literals.GetToken(2).symbol ==
+                   std::string(1000, 'x') + "\n");
+  }
+
+  TEST_METHOD(Arena_Allocations) {
+    Arena arena(256);
+    std::vector<std::string_view> copies;
+    for (int i = 0; i < 100; ++i) {
+      copies.push_back(arena.Copy(std::to_string(i * 7919)));
+    }
+    std::string_view large = arena.Copy(std::string(1000, 'l'));
+    for (int i = 0; i < 100; ++i) {
+      Assert::IsTrue(copies[i] == std::to_string(i * 7919),
+                     L"ARENA TEXT MOVED");
+    }
+    Assert::IsTrue(large == std::string(1000, 'l'));
+    char* aligned = arena.Allocate(24, alignof(uint64_t));
+    Assert::AreEqual(size_t(0),
+                     reinterpret_cast<uintptr_t>(aligned) % alignof(uint64_t));
+    Assert::IsTrue(arena.Allocate(0) != nullptr);
+
+    Arena moved = std::move(arena);
+    Assert::IsTrue(copies.front() == "0" && large.size() == 1000);
+    Assert::IsTrue(arena.Copy("after move") == "after move");
+  }
+
+  TEST_METHOD(LexerStats_Counters) {
+    const std::string source = "let x = 0x1F + y; # note\nprint(\"a\\n\");";
+    for (LexicAnalyzer::Engine engine : {LexicAnalyzer::Engine::STATE_MACHINE,
+                                         LexicAnalyzer::Engine::TABLE}) {
+      LexicAnalyzer analyzer(SourceBuffer(source.data(), source.size()),
+                             engine);
+      size_t token_count = analyzer.GetTokens().Size();
+      const LexerStats& stats = analyzer.GetStats();
+      uint64_t steps = 0, bytes = 0, tokens = 0;
+      for (size_t state = 0; state < LexerStats::kStateCount; ++state) {
+        steps += stats.GetSteps(static_cast<LexerStats::State>(state));
+        bytes += stats.GetBytes(static_cast<LexerStats::State>(state));
+      }
+      for (size_t type = 0; type < LexerStats::kTypeCount; ++type) {
+        tokens += stats.GetTokens(static_cast<Token::Type>(type));
+      }
+      if (!LexerStats::kEnabled) {
+        Assert::IsTrue(steps == 0 && bytes == 0 && tokens == 0);
+        continue;
+      }
+      Assert::AreEqual(uint64_t(source.size()), bytes);
+      Assert::AreEqual(uint64_t(token_count), tokens);
+      Assert::AreEqual(uint64_t(1),
+                       stats.GetTokens(Token::Type::NUMCONSTANT));
+      Assert::AreEqual(uint64_t(3), stats.GetTokens(Token::Type::IDENTIFIER));
+      bool is_table = engine == LexicAnalyzer::Engine::TABLE;
+      Assert::AreEqual(is_table ? steps : 0,
+                       stats.GetSteps(LexerStats::State::TABLE));
+      Assert::IsTrue(is_table ||
+                     stats.GetBytes(LexerStats::State::LITERAL) == 4);
+    }
+
+    LexerStats stats;
+    stats.AddPhase(LexerStats::Phase{"lexing", 0.5, 3});
+    std::ostringstream json;
+    stats.WriteJson(json);
+    Assert::IsTrue(json.str().find(
+                       "\"phases\": [{\"name\": \"lexing\", "
+                       "\"seconds\": 0.500000") != std::string::npos);
+  }
+
+  TEST_METHOD(HardwareCounters_Profile) {
+    // Counters may be missing here, which must only leave them out.
+    HardwareCounters counters;
+    Assert::IsTrue(counters.IsAvailable() || !counters.GetError().empty());
+    const std::string source(1 << 16, 'a');
+    LexicAnalyzer analyzer(SourceBuffer(source.data(), source.size()));
+    analyzer.SetProfiler(&counters);
+    HardwareCounters::Sample before = counters.Read();
+    analyzer.GetTokens();
+    HardwareCounters::Sample lexing = counters.Read() - before;
+    bool has_cycles = counters.IsAvailable(HardwareCounters::CYCLES);
+    Assert::IsTrue(has_cycles == (lexing[HardwareCounters::CYCLES] != 0));
+    uint64_t state_cycles = analyzer.GetStats()
+        .GetCounters(LexerStats::State::IDENTIFIER)[HardwareCounters::CYCLES];
+    Assert::IsTrue((LexerStats::kEnabled && has_cycles) ==
+                   (state_cycles != 0));
+
+    LexerStats stats;
+    stats.AddPhase(LexerStats::Phase{"lexing", 0.5, 3, lexing,
+                                     source.size(), 1});
+    stats.SetProfile(counters);
+    std::ostringstream json;
+    stats.WriteJson(json);
+    Assert::IsTrue(has_cycles == (json.str().find("\"per_byte\": {\"cycles")
+                                  != std::string::npos));
+    Assert::IsTrue(counters.GetError().empty() ==
+                   (json.str().find("counters_error") == std::string::npos));
   }
 
   TEST_METHOD(Operator_1) {
@@ -114,6 +1271,10 @@ TEST_CLASS(LexicAnalyzerUnitTest) {
     RunExceptionTest(L"numbers/4_input.txt");
   }
 
+  TEST_METHOD(Literals_1) {
+    RunTest(L"literals/1_input.txt", L"literals/1_expected.txt");
+  }
+
   TEST_METHOD(Full_1) { 
     RunTest(L"full/1_input.txt", L"full/1_expected.txt"); 
   }
@@ -129,6 +1290,11 @@ TEST_CLASS(LexicAnalyzerUnitTest) {
   TEST_METHOD(Full_4) { 
     RunTest(L"full/4_input.txt", L"full/4_expected.txt");
   }
+
+  // 5_input.txt keeps "\r\n" line ends on every platform.
+  TEST_METHOD(Full_5_crlf) {
+    RunTest(L"full/5_input.txt", L"full/5_expected.txt");
+  }
 };
 
 }  // namespace LexicAnalyzerUnitTest